@@ -510,6 +510,7 @@ void AActor::Init()
 	distance = 0;
 	dir = nodir;
 	trydir = nodir;
+	prevtic = 0;
 	soundZone = NULL;
 	inventory = NULL;
 
@@ -324,6 +324,9 @@ class AActor : public Thinker,
 #pragma pack(pop)
 		fixed z;
 		fixed	velx, vely;
+		fixed	prevx, prevy;	// Position at the start of the last tic, for interpolation
+		angle_t	prevangle;
+		int32_t	prevtic;	// gamestate.TimeCount for which prevx/y are valid
 
 		angle_t	angle;
 		angle_t pitch;
@@ -52,6 +52,8 @@
 #include "wl_play.h"
 #include "mapedit.h"
 #include "c_console.h"
+#include "r_2d/r_draw.h"
+#include "textures/textures.h"
 
 AutoMap::Color &AutoMap::Color::operator=(int rgb)
 {
@@ -198,6 +200,7 @@ void AM_UpdateFlags()
 void AM_Toggle()
 {
 	++automap;
+	AM_Main.InvalidateCache();
 	if(automap == AMA_Overlay && am_overlay == AMO_Off)
 		++automap;
 	else if(automap > AMA_Normal || (automap == AMA_Normal && am_overlay == AMO_On))
@@ -249,7 +252,7 @@ static const AMVectorPoint AM_Arrow[] =
 
 AutoMap::AutoMap(unsigned int flags) :
 	fullRefresh(true), amFlags(flags),
-	ampanx(0), ampany(0)
+	ampanx(0), ampany(0), staticCache(NULL), cacheValid(false)
 {
 	amangle = 0;
 	minmaxSel = 0;
@@ -269,6 +272,7 @@ AutoMap::~AutoMap()
 void AutoMap::CalculateDimensions(unsigned int x, unsigned int y, unsigned int width, unsigned int height)
 {
 	fullRefresh = true;
+	cacheValid = false;
 	amsizex = width;
 	amsizey = height;
 	amx = x;
@@ -340,16 +344,8 @@ public:
 };
 void AutoMap::Draw()
 {
-	TArray<AMPWall> pwalls;
-	TArray<FVector2> points;
-	const unsigned int mapwidth = map->GetHeader().width;
-	const unsigned int mapheight = map->GetHeader().height;
-
 	const fixed scale = GetScreenScale();
 
-	if(!(amFlags & AMF_Overlay))
-		screen->Clear(amx, amy+1, amx+amsizex, amy+amsizey+1, BackgroundColor.palcolor, BackgroundColor.color);
-
 	const fixed playerx = players[0].mo->x;
 	const fixed playery = players[0].mo->y;
 
@@ -374,12 +370,43 @@ void AutoMap::Draw()
 
 	const double originx = (amx+amsizex/2) - (FIXED2FLOAT(FixedMul(FixedMul(scale, ofsx&0xFFFF), amcos) - FixedMul(FixedMul(scale, ofsy&0xFFFF), amsin)));
 	const double originy = (amy+amsizey/2) - (FIXED2FLOAT(FixedMul(FixedMul(scale, ofsx&0xFFFF), amsin) + FixedMul(FixedMul(scale, ofsy&0xFFFF), amcos)));
+
+	if(!UpdateStaticCache(scale, ofsx, ofsy, originx, originy))
+	{
+		if(!(amFlags & AMF_Overlay))
+			screen->Clear(amx, amy+1, amx+amsizex, amy+amsizey+1, BackgroundColor.palcolor, BackgroundColor.color);
+		DrawStaticLayer(screen, scale, ofsx, ofsy, originx, originy);
+	}
+
+	DrawVector(AM_Arrow, 8, FixedMul(playerx - ofsx, scale), FixedMul(playery - ofsy, scale), scale, (amFlags & AMF_Rotate) ? 0 : ANGLE_90-players[0].mo->angle, ArrowColor);
+
+	if((amFlags & AMF_ShowThings) && (am_cheat || gamestate.fullmap))
+	{
+		for(AActor::Iterator iter = AActor::GetIterator();iter.Next();)
+		{
+			if(am_cheat || (gamestate.fullmap && (iter->flags & FL_PLOTONAUTOMAP)))
+				DrawActor(iter, FixedMul(iter->x - ofsx, scale), FixedMul(iter->y - ofsy, scale), scale);
+		}
+	}
+
+	DrawStats();
+}
+
+// Draws the tiles and pushwalls. Everything here only depends on the view
+// parameters and the state of the map so it can be cached between tics.
+void AutoMap::DrawStaticLayer(DCanvas *canvas, fixed scale, fixed ofsx, fixed ofsy, double originx, double originy)
+{
+	TArray<AMPWall> pwalls;
+	TArray<FVector2> points;
 	const double origTexScale = FIXED2FLOAT(scale>>6);
 
-	for(unsigned int my = 0;my < mapheight;++my)
+	unsigned int minx, miny, maxx, maxy;
+	GetVisibleTiles(scale, ofsx, ofsy, minx, miny, maxx, maxy);
+
+	for(unsigned int my = miny;my < maxy;++my)
 	{
-		MapSpot spot = map->GetSpot(0, my, 0);
-		for(unsigned int mx = 0;mx < mapwidth;++mx, ++spot)
+		MapSpot spot = map->GetSpot(minx, my, 0);
+		for(unsigned int mx = minx;mx < maxx;++mx, ++spot)
 		{
 			if(!((spot->amFlags & AM_Visible) || am_cheat || gamestate.fullmap) ||
 				((amFlags & AMF_Overlay) && (spot->amFlags & AM_DontOverlay)))
@@ -444,10 +471,10 @@ void AutoMap::Draw()
 					// graphics in the TILE8, we need to override the scaling.
 					if(tex->UseType == FTexture::TEX_FontChar)
 						texScale *= 8;
-					screen->FillSimplePoly(tex, &points[0], points.Size(), originx, originy, texScale, texScale, ~amangle, &NormalLight, brightness);
+					canvas->FillSimplePoly(tex, &points[0], points.Size(), originx, originy, texScale, texScale, ~amangle, &NormalLight, brightness);
 				}
 				else if(color)
-					screen->FillSimplePoly(NULL, &points[0], points.Size(), originx, originy, texScale, texScale, ~amangle, &NormalLight, brightness, color->palcolor, color->color);
+					canvas->FillSimplePoly(NULL, &points[0], points.Size(), originx, originy, texScale, texScale, ~amangle, &NormalLight, brightness, color->palcolor, color->color);
 			}
 
 			// We need to check this even if the origin tile isn't visible since
@@ -496,25 +523,12 @@ void AutoMap::Draw()
 				// Noah's ark TILE8
 				if(tex->UseType == FTexture::TEX_FontChar)
 					texScale *= 8;
-				screen->FillSimplePoly(tex, &pwall.points[0], pwall.points.Size(), originx + pwall.shiftx, originy + pwall.shifty, texScale, texScale, ~amangle, &NormalLight, 256);
+				canvas->FillSimplePoly(tex, &pwall.points[0], pwall.points.Size(), originx + pwall.shiftx, originy + pwall.shifty, texScale, texScale, ~amangle, &NormalLight, 256);
 			}
 		}
 		else
-			screen->FillSimplePoly(NULL, &pwall.points[0], pwall.points.Size(), originx + pwall.shiftx, originy + pwall.shifty, origTexScale, origTexScale, ~amangle, &NormalLight, 256, WallColor.palcolor, WallColor.color);
+			canvas->FillSimplePoly(NULL, &pwall.points[0], pwall.points.Size(), originx + pwall.shiftx, originy + pwall.shifty, origTexScale, origTexScale, ~amangle, &NormalLight, 256, WallColor.palcolor, WallColor.color);
 	}
-
-	DrawVector(AM_Arrow, 8, FixedMul(playerx - ofsx, scale), FixedMul(playery - ofsy, scale), scale, (amFlags & AMF_Rotate) ? 0 : ANGLE_90-players[0].mo->angle, ArrowColor);
-
-	if((amFlags & AMF_ShowThings) && (am_cheat || gamestate.fullmap))
-	{
-		for(AActor::Iterator iter = AActor::GetIterator();iter.Next();)
-		{
-			if(am_cheat || (gamestate.fullmap && (iter->flags & FL_PLOTONAUTOMAP)))
-				DrawActor(iter, FixedMul(iter->x - ofsx, scale), FixedMul(iter->y - ofsy, scale), scale);
-		}
-	}
-
-	DrawStats();
 }
 
 void AutoMap::DrawActor(AActor *actor, fixed x, fixed y, fixed scale)
@@ -782,6 +796,47 @@ fixed AutoMap::GetScreenScale() const
 	return minscale + FixedMul(absscale, (screenHeight<<(FRACBITS-3)) - minscale);
 }
 
+// Finds the range of tiles [x1, x2) x [y1, y2) which may land in the automap
+// area by running the corners of the area through the inverse of the
+// transformation in TransformTile. TransformTile still does the exact test.
+void AutoMap::GetVisibleTiles(fixed scale, fixed ofsx, fixed ofsy, unsigned int &x1, unsigned int &y1, unsigned int &x2, unsigned int &y2) const
+{
+	const double fscale = FIXED2FLOAT(scale);
+	const double fsin = FIXED2FLOAT(amsin);
+	const double fcos = FIXED2FLOAT(amcos);
+	double minx = 0, miny = 0, maxx = 0, maxy = 0;
+
+	for(unsigned int i = 0;i < 4;++i)
+	{
+		const double sx = (i&1) ? amsizex/2.0 : -amsizex/2.0;
+		const double sy = (i&2) ? amsizey/2.0 : -amsizey/2.0;
+		const double tx = (sx*fcos + sy*fsin)/fscale;
+		const double ty = (sy*fcos - sx*fsin)/fscale;
+
+		if(i == 0)
+		{
+			minx = maxx = tx;
+			miny = maxy = ty;
+		}
+		else
+		{
+			minx = MIN(minx, tx);
+			maxx = MAX(maxx, tx);
+			miny = MIN(miny, ty);
+			maxy = MAX(maxy, ty);
+		}
+	}
+
+	// A tile extends one unit from its origin and pushwalls may be drawn up
+	// to a tile away from their spot, so pad the range accordingly.
+	const double mapwidth = map->GetHeader().width;
+	const double mapheight = map->GetHeader().height;
+	x1 = (unsigned int)clamp<double>(floor(minx + FIXED2FLOAT(ofsx)) - 2, 0, mapwidth);
+	x2 = (unsigned int)clamp<double>(floor(maxx + FIXED2FLOAT(ofsx)) + 2, 0, mapwidth);
+	y1 = (unsigned int)clamp<double>(floor(miny + FIXED2FLOAT(ofsy)) - 2, 0, mapheight);
+	y2 = (unsigned int)clamp<double>(floor(maxy + FIXED2FLOAT(ofsy)) + 2, 0, mapheight);
+}
+
 void AutoMap::SetFlags(unsigned int flags, bool set)
 {
 	if(set)
@@ -864,6 +919,77 @@ bool AutoMap::TransformTile(MapSpot spot, fixed x, fixed y, TArray<FVector2> &po
 	return true;
 }
 
+// Renders the static layer to an offscreen canvas if anything affecting it
+// has changed and copies it to the screen. Returns false if the caller should
+// draw the static layer directly.
+bool AutoMap::UpdateStaticCache(fixed scale, fixed ofsx, fixed ofsy, double originx, double originy)
+{
+	// The overlay is composited with the 3D view, and the map editor can
+	// modify tiles without the game ticking, so only cache the full map.
+	if((amFlags & AMF_Overlay) || me_marker || screen->GetBuffer() == NULL)
+		return false;
+
+	if(staticCache && (staticCache->GetWidth() != screen->GetWidth() || staticCache->GetHeight() != screen->GetHeight()))
+	{
+		GC::DelSoftRoot(staticCache);
+		staticCache->Destroy();
+		staticCache = NULL;
+	}
+
+	if(staticCache == NULL)
+	{
+		staticCache = new DSimpleCanvas(screen->GetWidth(), screen->GetHeight());
+		staticCache->Lock();
+		GC::AddSoftRoot(staticCache);
+		cacheValid = false;
+	}
+
+	// Textured polygons are drawn through ylookup which is set up for the
+	// screen's pitch.
+	if(staticCache->GetPitch() != screen->GetPitch())
+		return false;
+
+	const bool cheat = am_cheat || gamestate.fullmap;
+	if(!cacheValid || cacheFlags != amFlags || cacheScale != scale ||
+		cacheOfsX != ofsx || cacheOfsY != ofsy || cacheAngle != amangle ||
+		cacheMapGeneration != GameMap::GetChangeGeneration() || cacheCheat != cheat ||
+		cacheAnimGeneration != TexMan.GetAnimationGeneration())
+	{
+		cacheFlags = amFlags;
+		cacheScale = scale;
+		cacheOfsX = ofsx;
+		cacheOfsY = ofsy;
+		cacheAngle = amangle;
+		cacheMapGeneration = GameMap::GetChangeGeneration();
+		cacheCheat = cheat;
+		cacheAnimGeneration = TexMan.GetAnimationGeneration();
+
+		BYTE *destorgsave = dc_destorg;
+		dc_destorg = staticCache->GetBuffer();
+
+		staticCache->Clear(amx, amy+1, amx+amsizex, amy+amsizey+1, BackgroundColor.palcolor, BackgroundColor.color);
+		DrawStaticLayer(staticCache, scale, ofsx, ofsy, originx, originy);
+
+		dc_destorg = destorgsave;
+		cacheValid = true;
+	}
+
+	const int left = MAX(amx, 0);
+	const int right = MIN(amx+amsizex, screen->GetWidth());
+	const int top = MAX(amy+1, 0);
+	const int bottom = MIN(amy+amsizey+1, screen->GetHeight());
+	if(left >= right)
+		return true;
+
+	R_SyncRefresh();
+	const int pitch = screen->GetPitch();
+	const BYTE *src = staticCache->GetBuffer() + top*pitch + left;
+	BYTE *dest = screen->GetBuffer() + top*pitch + left;
+	for(int y = top;y < bottom;++y, src += pitch, dest += pitch)
+		memcpy(dest, src, right - left);
+	return true;
+}
+
 void BasicOverhead()
 {
 	MapEdit::AdjustGameMap adjustGameMap;
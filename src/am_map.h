@@ -65,6 +65,8 @@ void AM_Toggle();
 void BasicOverhead();
 
 struct AMVectorPoint;
+class DCanvas;
+class DSimpleCanvas;
 
 class AutoMap
 {
@@ -95,6 +97,7 @@ public:
 	void Draw();
 	fixed GetScale() const { return absscale; }
 	fixed GetScreenScale() const;
+	void InvalidateCache() { cacheValid = false; }
 	void SetFlags(unsigned int flags, bool set);
 	void SetPanning(fixed x, fixed y, bool relative);
 	void SetScale(fixed scale, bool relative);
@@ -103,10 +106,13 @@ protected:
 	void ClipTile(TArray<FVector2> &points) const;
 	void DrawActor(class AActor *actor, fixed x, fixed y, fixed scale);
 	void DrawClippedLine(int x0, int y0, int x1, int y1, int palcolor, uint32 realcolor) const;
+	void DrawStaticLayer(DCanvas *canvas, fixed scale, fixed ofsx, fixed ofsy, double originx, double originy);
 	void DrawStats() const;
 	void DrawVector(const AMVectorPoint *points, unsigned int numPoints, fixed x, fixed y, fixed scale, angle_t angle, const Color &c) const;
 	FVector2 GetClipIntersection(const FVector2 &p1, const FVector2 &p2, unsigned edge) const;
+	void GetVisibleTiles(fixed scale, fixed ofsx, fixed ofsy, unsigned int &x1, unsigned int &y1, unsigned int &x2, unsigned int &y2) const;
 	bool TransformTile(MapSpot spot, fixed x, fixed y, TArray<FVector2> &points) const;
+	bool UpdateStaticCache(fixed scale, fixed ofsx, fixed ofsy, double originx, double originy);
 
 private:
 	double rottable[2][2];
@@ -120,6 +126,17 @@ private:
 	angle_t amangle;
 	unsigned short minmaxSel;
 
+	// The tiles don't change unless the view or the map does, so for the full
+	// screen automap we render them once and blit the result.
+	DSimpleCanvas *staticCache;
+	bool cacheValid;
+	unsigned int cacheFlags;
+	fixed cacheScale, cacheOfsX, cacheOfsY;
+	angle_t cacheAngle;
+	unsigned int cacheMapGeneration;
+	unsigned int cacheAnimGeneration;
+	bool cacheCheat;
+
 	Color ArrowColor;
 	Color BackgroundColor;
 	Color FloorColor;
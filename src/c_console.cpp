@@ -42,6 +42,10 @@
 #include <string.h>
 #include <math.h>
 #include <stdlib.h>
+#include <time.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 #include "version.h"
 //#include "g_game.h"
@@ -201,6 +205,108 @@ static void setmsgcolor (int index, int color);
 
 FILE *Logfile = NULL;
 
+//==========================================================================
+//
+// Log writer
+//
+// Text for the log file is queued here and written by a background thread,
+// so a mod spamming the console doesn't stall the game on file I/O.  Color
+// codes are also stripped on the writer thread.  If the queue fills up the
+// game waits for the writer rather than dropping output.
+//
+//==========================================================================
+
+static const unsigned int LOGQUEUE_SIZE = 1024;
+
+static struct FLogQueue
+{
+	std::thread Thread;
+	std::mutex Lock;
+	std::condition_variable Wake;
+	std::condition_variable Space;
+	FString Lines[LOGQUEUE_SIZE];
+	unsigned int Head, Tail;
+	bool Stop;
+} LogQueue;
+
+static void C_LogWriterThread ()
+{
+	TArray<FString> lines;
+	std::unique_lock<std::mutex> lock(LogQueue.Lock);
+	for (;;)
+	{
+		LogQueue.Wake.wait(lock, [] { return LogQueue.Stop || LogQueue.Head != LogQueue.Tail; });
+		if (LogQueue.Head == LogQueue.Tail)
+			break;
+
+		while (LogQueue.Tail != LogQueue.Head)
+		{
+			FString &line = LogQueue.Lines[LogQueue.Tail++ % LOGQUEUE_SIZE];
+			lines.Push(line);
+			line = FString();
+		}
+		LogQueue.Space.notify_all();
+		lock.unlock();
+
+		for (unsigned int i = 0; i < lines.Size(); ++i)
+			FConsoleBuffer::WriteLineToLog(Logfile, lines[i]);
+		fflush(Logfile);
+		lines.Clear();
+
+		lock.lock();
+	}
+}
+
+void C_LogText (const char *text)
+{
+	if (Logfile == NULL)
+		return;
+
+	FString line(text);
+	std::unique_lock<std::mutex> lock(LogQueue.Lock);
+	LogQueue.Space.wait(lock, [] { return LogQueue.Head - LogQueue.Tail < LOGQUEUE_SIZE; });
+	LogQueue.Lines[LogQueue.Head++ % LOGQUEUE_SIZE] = line;
+	lock.unlock();
+	LogQueue.Wake.notify_one();
+}
+
+static void C_CloseLogfile ()
+{
+	if (Logfile == NULL)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(LogQueue.Lock);
+		LogQueue.Stop = true;
+	}
+	LogQueue.Wake.notify_one();
+	LogQueue.Thread.join();
+
+	fclose(Logfile);
+	Logfile = NULL;
+}
+
+void execLogfile (const char *fn)
+{
+	C_CloseLogfile();
+
+	if ((Logfile = fopen(fn, "w")))
+	{
+		LogQueue.Head = LogQueue.Tail = 0;
+		LogQueue.Stop = false;
+		LogQueue.Thread = std::thread(C_LogWriterThread);
+
+		// Include anything printed before the log was opened.
+		if (conbuffer != NULL)
+			conbuffer->WriteContentToLog(Logfile);
+
+		time_t now = time(NULL);
+		Printf("Log started: %s", ctime(&now));
+	}
+	else
+		Printf("Could not start log\n");
+}
+
 void C_AddNotifyString (int printlevel, const char *source);
 
 
@@ -463,6 +569,8 @@ void C_DeinitConsole ()
 		delete conbuffer;
 		conbuffer = NULL;
 	}
+
+	C_CloseLogfile ();
 }
 
 static void ClearConsole ()
@@ -577,8 +685,7 @@ int PrintString (int printlevel, const char *outline)
 	}
 	else if (Logfile != NULL)
 	{
-		fputs (outline, Logfile);
-		fflush (Logfile);
+		C_LogText (outline);
 	}
 	return (int)strlen (outline);
 }
@@ -1547,6 +1654,19 @@ CCMD (echo)
 	}
 }
 
+CCMD (logfile)
+{
+	if (Logfile != NULL)
+	{
+		time_t now = time(NULL);
+		Printf("Log stopped: %s", ctime(&now));
+		C_CloseLogfile();
+	}
+
+	if (argv.argc() >= 2)
+		execLogfile(argv[1]);
+}
+
 CCMD (toggleconsole)
 {
 	C_ToggleConsole();
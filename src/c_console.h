@@ -65,6 +65,7 @@ void C_Ticker (void);
 
 void AddToConsole (int printlevel, const char *string);
 int PrintString (int printlevel, const char *string);
+void C_LogText (const char *text);
 int VPrintf (int printlevel, const char *format, va_list parms) GCCFORMAT(2);
 
 void C_DrawConsole (bool hw2d);
@@ -138,12 +138,12 @@ void FConsoleBuffer::AddText(int printlevel, const char *text, FILE *logfile)
 	// don't bother about linefeeds etc. inside the text, we'll let the formatter sort this out later.
 	build.AppendCStrPart(text, textsize);
 	mConsoleText.Push(build);
-	if (logfile != NULL) WriteLineToLog(logfile, text);
+	if (logfile != NULL) C_LogText(text);
 }
 
 //==========================================================================
 //
-//
+// Called from the log writer thread, so this must not touch the buffer.
 //
 //==========================================================================
 
@@ -195,7 +195,6 @@ void FConsoleBuffer::WriteLineToLog(FILE *LogFile, const char *outline)
 
 	fputs (copy, LogFile);
 	delete [] copy;
-	fflush (LogFile);
 }
 
 //==========================================================================
@@ -210,7 +209,7 @@ void FConsoleBuffer::WriteContentToLog(FILE *LogFile)
 	{
 		for (unsigned i = 0; i < mConsoleText.Size(); i++)
 		{
-			WriteLineToLog(LogFile, mConsoleText[i]);
+			C_LogText(mConsoleText[i] + "\n");
 		}
 	}
 }
@@ -223,7 +222,7 @@ void FConsoleBuffer::WriteContentToLog(FILE *LogFile)
 
 void FConsoleBuffer::Linefeed(FILE *Logfile)
 {
-	if (mAddType != NEWLINE && Logfile != NULL) fputc('\n', Logfile);
+	if (mAddType != NEWLINE && Logfile != NULL) C_LogText("\n");
 	mAddType = NEWLINE;
 }
 
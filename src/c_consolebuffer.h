@@ -61,7 +61,6 @@ class FConsoleBuffer
 	int mLastDisplayWidth;
 	bool mLastLineNeedsUpdate;
 
-	void WriteLineToLog(FILE *LogFile, const char *outline);
 	void FreeBrokenText(unsigned int start = 0, unsigned int end = INT_MAX);
 
 	void Linefeed(FILE *Logfile);
@@ -74,6 +73,7 @@ public:
 	void FormatText(FFont *formatfont, int displaywidth);
 	void ResizeBuffer(unsigned newsize);
 	void WriteContentToLog(FILE *logfile);
+	static void WriteLineToLog(FILE *LogFile, const char *outline);
 	void Clear()
 	{
 		mBufferWasCleared = true;
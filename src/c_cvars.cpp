@@ -48,6 +48,7 @@
 #include "c_bind.h"
 #include "colormatcher.h"
 #include "cmdlib.h"
+#include "dobject.h"
 
 static bool doWriteConfig = false;
 
@@ -55,6 +56,11 @@ Aspect r_ratio = ASPECT_4_3, vid_aspect = ASPECT_NONE;
 bool forcegrabmouse = false;
 bool vid_fullscreen = false;
 bool vid_vsync = false;
+bool vid_uncapped = false;
+bool vid_pipelined = false;
+unsigned int vid_warprate = 0;
+bool vid_mipmaps = false;
+unsigned int snd_imfcache = 0;
 bool quitonescape = false;
 fixed movebob = FRACUNIT;
 
@@ -191,9 +197,15 @@ void ReadConfig(void)
 	config.CreateSetting("SoundVolume", MAX_VOLUME);
 	config.CreateSetting("MusicVolume", MAX_VOLUME);
 	config.CreateSetting("DigitizedVolume", MAX_VOLUME);
+	config.CreateSetting("Snd_IMFCache", 0);
 	config.CreateSetting("Vid_FullScreen", false);
 	config.CreateSetting("Vid_Aspect", ASPECT_NONE);
 	config.CreateSetting("Vid_Vsync", false);
+	config.CreateSetting("Vid_Uncapped", false);
+	config.CreateSetting("Vid_Pipelined", false);
+	config.CreateSetting("Vid_WarpRate", 0);
+	config.CreateSetting("Vid_Mipmaps", false);
+	config.CreateSetting("GC_FrameBudget", 0);
 	config.CreateSetting("FullScreenWidth", fullScreenWidth);
 	config.CreateSetting("FullScreenHeight", fullScreenHeight);
 	config.CreateSetting("WindowedScreenWidth", windowedScreenWidth);
@@ -241,9 +253,15 @@ void ReadConfig(void)
 	SD_UpdatePCSpeakerVolume();
 	MusicVolume = config.GetSetting("MusicVolume")->GetInteger();
 	SoundVolume = config.GetSetting("DigitizedVolume")->GetInteger();
+	snd_imfcache = config.GetSetting("Snd_IMFCache")->GetInteger();
 	vid_fullscreen = config.GetSetting("Vid_FullScreen")->GetInteger() != 0;
 	vid_aspect = static_cast<Aspect>(config.GetSetting("Vid_Aspect")->GetInteger());
 	vid_vsync = config.GetSetting("Vid_Vsync")->GetInteger() != 0;
+	vid_uncapped = config.GetSetting("Vid_Uncapped")->GetInteger() != 0;
+	vid_pipelined = config.GetSetting("Vid_Pipelined")->GetInteger() != 0;
+	vid_warprate = config.GetSetting("Vid_WarpRate")->GetInteger();
+	vid_mipmaps = config.GetSetting("Vid_Mipmaps")->GetInteger() != 0;
+	GC::FrameBudget = config.GetSetting("GC_FrameBudget")->GetInteger();
 	fullScreenWidth = config.GetSetting("FullScreenWidth")->GetInteger();
 	fullScreenHeight = config.GetSetting("FullScreenHeight")->GetInteger();
 	windowedScreenWidth = config.GetSetting("WindowedScreenWidth")->GetInteger();
@@ -393,9 +411,15 @@ void WriteConfig(void)
 	config.GetSetting("SoundVolume")->SetValue(AdlibVolume);
 	config.GetSetting("MusicVolume")->SetValue(MusicVolume);
 	config.GetSetting("DigitizedVolume")->SetValue(SoundVolume);
+	config.GetSetting("Snd_IMFCache")->SetValue(snd_imfcache);
 	config.GetSetting("Vid_FullScreen")->SetValue(vid_fullscreen);
 	config.GetSetting("Vid_Aspect")->SetValue(vid_aspect);
 	config.GetSetting("Vid_Vsync")->SetValue(vid_vsync);
+	config.GetSetting("Vid_Uncapped")->SetValue(vid_uncapped);
+	config.GetSetting("Vid_Pipelined")->SetValue(vid_pipelined);
+	config.GetSetting("Vid_WarpRate")->SetValue(vid_warprate);
+	config.GetSetting("Vid_Mipmaps")->SetValue(vid_mipmaps);
+	config.GetSetting("GC_FrameBudget")->SetValue(GC::FrameBudget);
 	config.GetSetting("FullScreenWidth")->SetValue(fullScreenWidth);
 	config.GetSetting("FullScreenHeight")->SetValue(fullScreenHeight);
 	config.GetSetting("WindowedScreenWidth")->SetValue(windowedScreenWidth);
@@ -62,6 +62,11 @@ extern bool		r_depthfog;
 extern bool		vid_fullscreen;
 extern Aspect	vid_aspect;
 extern bool		vid_vsync;
+extern bool		vid_uncapped;
+extern bool		vid_pipelined;
+extern unsigned int	vid_warprate;	// Warp texture updates per second, 0 for every tic
+extern bool		vid_mipmaps;		// Sample distant walls and flats from mipmaps
+extern unsigned int	snd_imfcache;	// 0 synthesizes IMF music live, 1 renders it to memory, 2 also to disk
 extern bool		quitonescape;
 extern fixed	movebob;
 
@@ -37,6 +37,7 @@
 #include <stdlib.h>
 #include "wl_def.h"
 #include "m_alloc.h"
+#include "zstring.h"
 
 class ClassDef;
 
@@ -83,6 +84,12 @@ namespace GC
 	// Number of bytes currently allocated through M_Malloc/M_Realloc.
 	extern size_t AllocBytes;
 
+	// Highest AllocBytes seen when a sweep started, which is where it peaks.
+	extern size_t PeakAllocBytes;
+
+	// Number of collections that have run to completion.
+	extern unsigned int Cycles;
+
 	// Amount of memory to allocate before triggering a collection.
 	extern size_t Threshold;
 
@@ -107,6 +114,10 @@ namespace GC
 	// Size of GC steps.
 	extern int StepMul;
 
+	// Microseconds per frame IdleStep may spend collecting. While this is
+	// set CheckGC only steps once allocation gets twice past Threshold.
+	extern unsigned int FrameBudget;
+
 	// Current white value for known-dead objects.
 	static inline uint32 OtherWhite()
 	{
@@ -119,6 +130,13 @@ namespace GC
 	// Does one collection step.
 	void Step();
 
+	// Runs collection steps for up to usec microseconds if a collection is
+	// due or in progress. Meant for the time spent waiting on the next tic.
+	void IdleStep(unsigned int usec);
+
+	// Histogram of the time spent in Step and IdleStep.
+	FString PauseReport();
+
 	// Does a complete collection.
 	void FullGC();
 
@@ -144,7 +162,7 @@ namespace GC
 	// Check if it's time to collect, and do a collection step if it is.
 	static inline void CheckGC()
 	{
-		if (AllocBytes >= Threshold)
+		if (AllocBytes >= Threshold && (FrameBudget == 0 || AllocBytes/2 >= Threshold))
 			Step();
 	}
 
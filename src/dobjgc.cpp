@@ -56,6 +56,7 @@
 
 // HEADER FILES ------------------------------------------------------------
 
+#include <chrono>
 #include "actor.h"
 #include "dobject.h"
 #include "templates.h"
@@ -113,6 +114,11 @@
 #define GCSWEEPCOST		10
 #define GCFINALIZECOST	100
 
+// Upper bounds in microseconds of the pause time histogram buckets. The last
+// bucket takes everything longer.
+static const unsigned int PauseBuckets[] = { 50, 100, 250, 500, 1000, 2000, 5000 };
+#define NUM_PAUSEBUCKETS (countof(PauseBuckets)+1)
+
 // TYPES -------------------------------------------------------------------
 
 // This object is responsible for marking sectors during the propagate
@@ -145,6 +151,8 @@ IMPLEMENT_INTERNAL_CLASS(DSectorMarker)
 namespace GC
 {
 size_t AllocBytes;
+size_t PeakAllocBytes;
+unsigned int Cycles;
 size_t Threshold;
 size_t Estimate;
 DObject *Gray;
@@ -157,11 +165,31 @@ int Pause = DEFAULT_GCPAUSE;
 int StepMul = DEFAULT_GCMUL;
 int StepCount;
 size_t Dept;
+unsigned int FrameBudget = 0;
 
 // PRIVATE DATA DEFINITIONS ------------------------------------------------
 
 static DSectorMarker *SectorMarker;
 
+static unsigned int TickPauses[NUM_PAUSEBUCKETS], IdlePauses[NUM_PAUSEBUCKETS];
+static unsigned int LongestTickPause, LongestIdlePause;
+
+typedef std::chrono::steady_clock PauseClock;
+
+static unsigned int ElapsedMicroseconds(PauseClock::time_point start)
+{
+	return (unsigned int)std::chrono::duration_cast<std::chrono::microseconds>(PauseClock::now() - start).count();
+}
+
+static void RecordPause(unsigned int *histogram, unsigned int &longest, unsigned int usec)
+{
+	unsigned int i = 0;
+	while (i < countof(PauseBuckets) && usec >= PauseBuckets[i])
+		++i;
+	++histogram[i];
+	longest = MAX(longest, usec);
+}
+
 // CODE --------------------------------------------------------------------
 
 //==========================================================================
@@ -420,6 +448,8 @@ static size_t SingleStep()
 
 	case GCS_Sweep: {
 		size_t old = AllocBytes;
+		if (old > PeakAllocBytes)
+			PeakAllocBytes = old;
 		size_t finalize_count;
 		SweepPos = SweepList(SweepPos, GCSWEEPMAX, &finalize_count);
 		if (*SweepPos == NULL)
@@ -434,6 +464,7 @@ static size_t SingleStep()
 	case GCS_Finalize:
 		State = GCS_Pause;		// end collection
 		Dept = 0;
+		++Cycles;
 		return 0;
 
 	default:
@@ -453,6 +484,7 @@ static size_t SingleStep()
 
 void Step()
 {
+	const PauseClock::time_point start = PauseClock::now();
 	size_t lim = (GCSTEPSIZE/100) * StepMul;
 	size_t olim;
 	if (lim == 0)
@@ -483,6 +515,67 @@ void Step()
 		SetThreshold();
 	}
 	StepCount++;
+	RecordPause(TickPauses, LongestTickPause, ElapsedMicroseconds(start));
+}
+
+//==========================================================================
+//
+// IdleStep
+//
+// Works through the collection in single steps until it either finishes or
+// runs out of time. The threshold is left alone while a collection is in
+// progress, so CheckGC only gets involved if allocation outruns the budget.
+//
+//==========================================================================
+
+void IdleStep(unsigned int usec)
+{
+	if (State == GCS_Pause && AllocBytes < Threshold)
+		return;
+
+	const PauseClock::time_point start = PauseClock::now();
+	unsigned int elapsed;
+	do
+	{
+		SingleStep();
+		elapsed = ElapsedMicroseconds(start);
+	} while (State != GCS_Pause && elapsed < usec);
+
+	if (State == GCS_Pause)
+		SetThreshold();
+	StepCount++;
+	RecordPause(IdlePauses, LongestIdlePause, elapsed);
+}
+
+//==========================================================================
+//
+// PauseReport
+//
+//==========================================================================
+
+static void AppendHistogram(FString &out, const char *name, const unsigned int *histogram, unsigned int longest)
+{
+	out.AppendFormat("%s:", name);
+	for (unsigned int i = 0; i < NUM_PAUSEBUCKETS; ++i)
+	{
+		if (i < countof(PauseBuckets))
+			out.AppendFormat(" <%uus:%u", PauseBuckets[i], histogram[i]);
+		else
+			out.AppendFormat(" more:%u", histogram[i]);
+	}
+	out.AppendFormat(" longest:%uus", longest);
+}
+
+FString PauseReport()
+{
+	FString out;
+	AppendHistogram(out, "Tick", TickPauses, LongestTickPause);
+	if (FrameBudget != 0)
+	{
+		out += "\n";
+		AppendHistogram(out, "Idle", IdlePauses, LongestIdlePause);
+	}
+	return out;
 }
 
 //==========================================================================
@@ -735,6 +828,8 @@ ADD_STAT(gc)
 	{
 		out.AppendFormat("  %zuK", (GC::Dept + 1023) >> 10);
 	}
+	out += "\n";
+	out += GC::PauseReport();
 	return out;
 }
 
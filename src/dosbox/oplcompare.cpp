@@ -0,0 +1,140 @@
+/*
+** oplcompare.cpp
+**
+** Renders a fixed, pseudo random OPL2/OPL3 register stream through DBOPL and
+** writes the raw output to a file, printing the time spent generating. Run
+** it before and after changing the emulator to compare both the speed and
+** the output byte for byte.
+**
+** Usage: oplcompare <output> [seconds]
+*/
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Not a game executable, keep SDL from renaming main.
+#define SDL_MAIN_HANDLED
+#include "dosbox/dbopl.h"
+
+static const Bit32u RATE = 44100;
+// Music runs at 700 Hz, so registers change this often.
+static const Bit32u TICK_SAMPLES = RATE/700;
+
+static Bit32u seed = 0x12345678;
+static Bit32u Random()
+{
+	seed = seed*1664525 + 1013904223;
+	return seed >> 8;
+}
+
+// Operator register offsets in a bank, skipping the unused holes.
+static const Bit8u OperatorOffsets[18] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05,
+	0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D,
+	0x10, 0x11, 0x12, 0x13, 0x14, 0x15
+};
+
+static int volume = MAX_VOLUME;
+
+static void Write(DBOPL::Chip &chip, Bit32u reg, Bit8u val)
+{
+	chip.SetVolume(volume);
+	chip.WriteReg(reg, val);
+}
+
+// Sets up a random instrument on a channel and keys it on or off.
+static void Poke(DBOPL::Chip &chip, bool opl3)
+{
+	const Bit32u bank = opl3 && (Random() & 1) ? 0x100 : 0;
+	const unsigned int chan = Random() % 9;
+	const unsigned int op = OperatorOffsets[(chan/3)*6 + chan%3];
+
+	switch(Random() % 8)
+	{
+		default:
+			// Key on or off with a new frequency
+			Write(chip, bank + 0xA0 + chan, Random());
+			Write(chip, bank + 0xB0 + chan, Random() & 0x3F);
+			break;
+		case 0:
+			for(unsigned int i = 0; i < 2; ++i)
+			{
+				Write(chip, bank + 0x20 + op + i*3, Random());
+				Write(chip, bank + 0x40 + op + i*3, Random());
+				// Keep the attack going somewhere so there is something to hear
+				Write(chip, bank + 0x60 + op + i*3, Random() | 0x40);
+				Write(chip, bank + 0x80 + op + i*3, Random());
+				Write(chip, bank + 0xE0 + op + i*3, Random());
+			}
+			break;
+		case 1:
+			// Feedback, connection and, for OPL3, panning
+			Write(chip, bank + 0xC0 + chan, Random());
+			break;
+		case 2:
+			// Tremolo and vibrato depth, sometimes percussion
+			Write(chip, 0xBD, Random() & ((Random() & 7) ? 0xC0 : 0xFF));
+			break;
+		case 3:
+			if(opl3)
+				Write(chip, 0x104, Random() & 0x3F);
+			else if(!(Random() & 3))
+				volume = Random() % (MAX_VOLUME + 1);
+			break;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 2)
+	{
+		fprintf(stderr, "Usage: %s <output> [seconds]\n", argv[0]);
+		return 1;
+	}
+
+	FILE *out = fopen(argv[1], "wb");
+	if(!out)
+	{
+		fprintf(stderr, "Could not open %s.\n", argv[1]);
+		return 1;
+	}
+
+	const unsigned int seconds = argc > 2 ? atoi(argv[2]) : 60;
+	const unsigned int ticks = seconds*700;
+
+	std::chrono::steady_clock::duration elapsed(0);
+	Bit32s buffer[TICK_SAMPLES*2];
+
+	// The first half is plain OPL2, then the same in OPL3 mode.
+	for(unsigned int pass = 0; pass < 2; ++pass)
+	{
+		const bool opl3 = pass == 1;
+
+		DBOPL::Chip chip;
+		chip.Setup(RATE);
+		Write(chip, 0x01, 0x20);
+		if(opl3)
+			Write(chip, 0x105, 0x01);
+
+		for(unsigned int tick = 0; tick < ticks/2; ++tick)
+		{
+			for(unsigned int i = Random() % 4; i > 0; --i)
+				Poke(chip, opl3);
+
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			if(opl3)
+				chip.GenerateBlock3(TICK_SAMPLES, buffer);
+			else
+				chip.GenerateBlock2(TICK_SAMPLES, buffer);
+			elapsed += std::chrono::steady_clock::now() - start;
+
+			fwrite(buffer, sizeof(Bit32s), opl3 ? TICK_SAMPLES*2 : TICK_SAMPLES, out);
+		}
+	}
+	fclose(out);
+
+	printf("%u seconds of OPL2 and OPL3 generated in %.1f ms\n", seconds,
+		std::chrono::duration<double, std::milli>(elapsed).count());
+	return 0;
+}
@@ -43,6 +43,16 @@
 #include "templates.h"
 #include "zdoomsupport.h"
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <io.h>
+#include <mutex>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 //==========================================================================
 //
 // FileReader
@@ -149,6 +159,35 @@ long FileReader::Read (void *buffer, long len)
 	return len;
 }
 
+long FileReader::ReadAt (void *buffer, long len, long offset)
+{
+	if (offset < 0 || len <= 0 || offset >= Length) return 0;
+	if (len > Length - offset) len = Length - offset;
+
+#ifdef _WIN32
+	// There's no positional read for stdio streams so serialize access and
+	// put the stream back where it was.
+	static std::mutex readMutex;
+	std::lock_guard<std::mutex> lock(readMutex);
+
+	long oldpos = ftell(File);
+	fseek(File, StartPos + offset, SEEK_SET);
+	len = (long)fread(buffer, 1, len, File);
+	fseek(File, oldpos, SEEK_SET);
+	return len;
+#else
+	long total = 0;
+	while (total < len)
+	{
+		ssize_t got = pread(fileno(File), (char *)buffer + total, len - total, StartPos + offset + total);
+		if (got <= 0)
+			break;
+		total += got;
+	}
+	return total;
+#endif
+}
+
 char *FileReader::Gets(char *strbuf, int len)
 {
 	if (len <= 0 || FilePos >= StartPos + Length) return NULL;
@@ -539,7 +578,123 @@ long MemoryReader::Read (void *buffer, long len)
 	return len;
 }
 
+long MemoryReader::ReadAt (void *buffer, long len, long offset)
+{
+	if (offset < 0 || offset > Length) return 0;
+	if (len > Length - offset) len = Length - offset;
+	if (len < 0) len = 0;
+	memcpy(buffer, bufptr + offset, len);
+	return len;
+}
+
 char *MemoryReader::Gets(char *strbuf, int len)
 {
 	return GetsFromBuffer(bufptr, strbuf, len);
 }
+
+//==========================================================================
+//
+// MappedFileReader
+//
+// reads data from a file mapped into memory (copy on write)
+//
+//==========================================================================
+
+MappedFileReader::MappedFileReader (const char *filename)
+: FileReader(filename), Mapping(NULL)
+#ifdef _WIN32
+, MappingHandle(NULL)
+#endif
+{
+	Map();
+}
+
+MappedFileReader::~MappedFileReader ()
+{
+	if (Mapping != NULL)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(Mapping);
+		CloseHandle(MappingHandle);
+#else
+		munmap(Mapping, Length);
+#endif
+	}
+}
+
+void MappedFileReader::Map ()
+{
+	if (Length <= 0)
+		return;
+
+#ifdef _WIN32
+	HANDLE file = (HANDLE)_get_osfhandle(_fileno(File));
+	MappingHandle = CreateFileMapping(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+	if (MappingHandle != NULL)
+	{
+		Mapping = (char *)MapViewOfFile(MappingHandle, FILE_MAP_COPY, 0, 0, 0);
+		if (Mapping == NULL)
+		{
+			CloseHandle(MappingHandle);
+			MappingHandle = NULL;
+		}
+	}
+#else
+	// Private writable mapping since callers may modify cached lumps in place.
+	void *ptr = mmap(NULL, Length, PROT_READ|PROT_WRITE, MAP_PRIVATE, fileno(File), 0);
+	if (ptr != MAP_FAILED)
+		Mapping = (char *)ptr;
+#endif
+}
+
+long MappedFileReader::Seek (long offset, int origin)
+{
+	if (Mapping == NULL)
+		return FileReader::Seek(offset, origin);
+
+	switch (origin)
+	{
+	case SEEK_CUR:
+		offset += FilePos;
+		break;
+
+	case SEEK_END:
+		offset += Length;
+		break;
+	}
+	if (offset < 0 || offset > Length)
+		return -1;
+	FilePos = offset;
+	return 0;
+}
+
+long MappedFileReader::Read (void *buffer, long len)
+{
+	if (Mapping == NULL)
+		return FileReader::Read(buffer, len);
+
+	if (len > Length - FilePos) len = Length - FilePos;
+	if (len < 0) len = 0;
+	memcpy(buffer, Mapping + FilePos, len);
+	FilePos += len;
+	return len;
+}
+
+long MappedFileReader::ReadAt (void *buffer, long len, long offset)
+{
+	if (Mapping == NULL)
+		return FileReader::ReadAt(buffer, len, offset);
+
+	if (offset < 0 || offset > Length) return 0;
+	if (len > Length - offset) len = Length - offset;
+	if (len < 0) len = 0;
+	memcpy(buffer, Mapping + offset, len);
+	return len;
+}
+
+char *MappedFileReader::Gets(char *strbuf, int len)
+{
+	if (Mapping == NULL)
+		return FileReader::Gets(strbuf, len);
+	return GetsFromBuffer(Mapping, strbuf, len);
+}
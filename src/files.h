@@ -72,6 +72,10 @@ public:
 	virtual char *Gets(char *strbuf, int len);
 	long GetLength () const { return Length; }
 
+	// Reads len bytes at offset without using or changing the current
+	// position, so it may be called from several threads at once.
+	virtual long ReadAt (void *buffer, long len, long offset);
+
 	// If you use the underlying FILE without going through this class,
 	// you must call ResetFilePtr() before using this class again.
 	void ResetFilePtr ();
@@ -329,6 +333,7 @@ public:
 	virtual long Tell () const;
 	virtual long Seek (long offset, int origin);
 	virtual long Read (void *buffer, long len);
+	virtual long ReadAt (void *buffer, long len, long offset);
 	virtual char *Gets(char *strbuf, int len);
 	virtual const char *GetBuffer() const { return bufptr; }
 
@@ -336,6 +341,29 @@ protected:
 	const char * bufptr;
 };
 
+// Maps a whole file into memory so that uncompressed lumps can be used in
+// place. Behaves like a plain FileReader if the file can't be mapped.
+class MappedFileReader : public FileReader
+{
+public:
+	MappedFileReader (const char *filename);
+	~MappedFileReader ();
+
+	virtual long Seek (long offset, int origin);
+	virtual long Read (void *buffer, long len);
+	virtual long ReadAt (void *buffer, long len, long offset);
+	virtual char *Gets(char *strbuf, int len);
+	virtual const char *GetBuffer() const { return Mapping; }
+
+protected:
+	void Map ();
+
+	char *Mapping;
+#ifdef _WIN32
+	void *MappingHandle;
+#endif
+};
+
 
 
 #endif
@@ -142,6 +142,7 @@ void SetupPaths(int argc, const char * const *argv)
 	FString &appsupportDir = SpecialPaths[DIR_ApplicationSupport];
 	FString &documentsDir = SpecialPaths[DIR_Documents];
 	FString &screenshotsDir = SpecialPaths[DIR_Screenshots];
+	FString &cacheDir = SpecialPaths[DIR_Cache];
 
 	// Setup platform specific folder location functions
 #if defined(_WIN32)
@@ -364,6 +365,27 @@ void SetupPaths(int argc, const char * const *argv)
 
 	if(!CreateDirectoryIfNeeded(screenshotsDir))
 		screenshotsDir = configDir;
+
+	// Cache directory, for data which can be regenerated at any time
+#if defined(_WIN32)
+	cacheDir = configDir + "\\cache";
+#elif defined(__APPLE__)
+	cacheDir = configDir + "/Cache";
+#else
+	char *xdg_cache = getenv("XDG_CACHE_HOME");
+	if(xdg_cache == NULL || *xdg_cache == '\0')
+	{
+		if(home == NULL || *home == '\0')
+			cacheDir = configDir;
+		else
+			cacheDir.Format("%s/.cache/" GAME_DIR, home);
+	}
+	else
+		cacheDir.Format("%s/" GAME_DIR, xdg_cache);
+#endif
+
+	if(!CreateDirectoryIfNeeded(cacheDir))
+		cacheDir = configDir;
 }
 
 }
@@ -54,6 +54,7 @@ namespace FileSys
 		DIR_ApplicationSupport,
 		DIR_Documents,
 		DIR_Screenshots,
+		DIR_Cache,
 
 		NUM_SPECIAL_DIRECTORIES
 	};
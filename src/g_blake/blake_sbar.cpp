@@ -70,21 +70,24 @@ public:
 	void NewGame()
 	{
 		CurrentScore = players[0].score;
+		TopArea.Invalidate();
+		BottomArea.Invalidate();
 	}
 
 	void Tick();
 
 protected:
-	void DrawLed(double percent, double x, double y) const;
-	void DrawString(FFont *font, const char* string, double x, double y, bool shadow, EColorRange color=CR_UNTRANSLATED, bool center=false) const;
+	void DrawLed(FRetainedArea &area, double percent, double x, double y) const;
+	void DrawString(FRetainedArea &area, FFont *font, const char* string, double x, double y, bool shadow, EColorRange color=CR_UNTRANSLATED, bool center=false) const;
 
 private:
 	int CurrentScore;
+	FRetainedArea TopArea, BottomArea;
 };
 
 DBaseStatusBar *CreateStatusBar_Blake() { return new BlakeStatusBar(); }
 
-void BlakeStatusBar::DrawLed(double percent, double x, double y) const
+void BlakeStatusBar::DrawLed(FRetainedArea &area, double percent, double x, double y) const
 {
 	static FTextureID LED[2][3] = {
 		{TexMan.GetTexture("STLEDDR", FTexture::TEX_Any), TexMan.GetTexture("STLEDDY", FTexture::TEX_Any), TexMan.GetTexture("STLEDDG", FTexture::TEX_Any)},
@@ -105,16 +108,8 @@ void BlakeStatusBar::DrawLed(double percent, double x, double y) const
 	screen->VirtualToRealCoords(x, y, w, h, 320, 200, true, true);
 
 	int lightclip = xs_ToInt(y + h*(1-percent));
-	screen->DrawTexture(dim, x, y,
-		DTA_DestWidthF, w,
-		DTA_DestHeightF, h,
-		DTA_ClipBottom, lightclip,
-		TAG_DONE);
-	screen->DrawTexture(light, x, y,
-		DTA_DestWidthF, w,
-		DTA_DestHeightF, h,
-		DTA_ClipTop, lightclip,
-		TAG_DONE);
+	area.AddGraphic(dim, x, y, w, h, NULL, 0xFFFFFFFF, 0, lightclip);
+	area.AddGraphic(light, x, y, w, h, NULL, 0xFFFFFFFF, lightclip);
 }
 
 void BlakeStatusBar::DrawStatusBar()
@@ -136,10 +131,9 @@ void BlakeStatusBar::DrawStatusBar()
 	screen->VirtualToRealCoords(stx, sty, stw, sth, 320, 200, true, true);
 	int boty = xs_ToInt(sty);
 
-	screen->DrawTexture(TexMan(STBar), stx, sty,
-		DTA_DestWidthF, stw,
-		DTA_DestHeightF, sth,
-		TAG_DONE);
+	// Widgets only record what they draw, each area then repaints whichever
+	// of them changed since the last frame.
+	BottomArea.Begin(TexMan(STBar), stx, sty, stw, sth);
 
 	stx = 0;
 	sty = 0;
@@ -148,10 +142,7 @@ void BlakeStatusBar::DrawStatusBar()
 	screen->VirtualToRealCoords(stx, sty, stw, sth, 320, 200, true, true);
 	int topy = xs_ToInt(sth);
 
-	screen->DrawTexture(TexMan(STBarTop), stx, 0.0,
-		DTA_DestWidthF, stw,
-		DTA_DestHeightF, sth,
-		TAG_DONE);
+	TopArea.Begin(TexMan(STBarTop), stx, 0.0, stw, sth);
 
 	if(viewsize < 20)
 	{
@@ -177,19 +168,26 @@ void BlakeStatusBar::DrawStatusBar()
 	else
 		area.Format("AREA: %d", levelInfo->LevelNumber);
 	lives.Format("LIVES: %d", players[0].lives);
-	DrawString(IndexFont, area, 18, 5, true, CR_WHITE);
-	DrawString(IndexFont, levelInfo->GetName(map), 160, 5, true, CR_WHITE, true);
-	DrawString(IndexFont, lives, 267, 5, true, CR_WHITE);
+	TopArea.BeginWidget();
+	DrawString(TopArea, IndexFont, area, 18, 5, true, CR_WHITE);
+	TopArea.BeginWidget();
+	DrawString(TopArea, IndexFont, levelInfo->GetName(map), 160, 5, true, CR_WHITE, true);
+	TopArea.BeginWidget();
+	DrawString(TopArea, IndexFont, lives, 267, 5, true, CR_WHITE);
+	TopArea.Finish();
 
 	// Draw bottom information
 	FString health;
 	health.Format("%3d", players[0].health);
-	DrawString(HealthFont, health, 128, 162, false);
+	BottomArea.BeginWidget();
+	DrawString(BottomArea, HealthFont, health, 128, 162, false);
 
 	FString score;
 	score.Format("%7d", CurrentScore);
-	DrawString(ScoreFont, score, 256, 155, false);
+	BottomArea.BeginWidget();
+	DrawString(BottomArea, ScoreFont, score, 256, 155, false);
 
+	BottomArea.BeginWidget();
 	if(players[0].ReadyWeapon)
 	{
 		FTexture *weapon = TexMan(players[0].ReadyWeapon->icon);
@@ -200,29 +198,31 @@ void BlakeStatusBar::DrawStatusBar()
 			stw = weapon->GetScaledWidthDouble();
 			sth = weapon->GetScaledHeightDouble();
 			screen->VirtualToRealCoords(stx, sty, stw, sth, 320, 200, true, true);
-			screen->DrawTexture(weapon, stx, sty,
-				DTA_DestWidthF, stw,
-				DTA_DestHeightF, sth,
-				TAG_DONE);
+			BottomArea.AddGraphic(weapon, stx, sty, stw, sth);
 		}
+	}
 
+	BottomArea.BeginWidget();
+	if(players[0].ReadyWeapon)
+	{
 		// TODO: Fix color
 		unsigned int amount = players[0].ReadyWeapon->ammo[AWeapon::PrimaryFire]->amount;
-		DrawLed(static_cast<double>(amount)/static_cast<double>(players[0].ReadyWeapon->ammo[AWeapon::PrimaryFire]->maxamount), 243, 155);
+		DrawLed(BottomArea, static_cast<double>(amount)/static_cast<double>(players[0].ReadyWeapon->ammo[AWeapon::PrimaryFire]->maxamount), 243, 155);
 
 		FString ammo;
 		ammo.Format("%3d%%", amount);
-		DrawString(IndexFont, ammo, 252, 190, false, CR_LIGHTBLUE);
+		DrawString(BottomArea, IndexFont, ammo, 252, 190, false, CR_LIGHTBLUE);
 	}
 
+	BottomArea.BeginWidget();
 	if(players[0].mo)
 	{
 		static const ClassDef * const radarPackCls = ClassDef::FindClass("RadarPack");
 		AInventory *radarPack = players[0].mo->FindInventory(radarPackCls);
 		if(radarPack)
-			DrawLed(static_cast<double>(radarPack->amount)/static_cast<double>(radarPack->maxamount), 235, 155);
+			DrawLed(BottomArea, static_cast<double>(radarPack->amount)/static_cast<double>(radarPack->maxamount), 235, 155);
 		else
-			DrawLed(0, 235, 155);
+			DrawLed(BottomArea, 0, 235, 155);
 	}
 
 	// Find keys in inventory
@@ -250,6 +250,8 @@ void BlakeStatusBar::DrawStatusBar()
 	};
 	for(unsigned int i = 0;i < 3;++i)
 	{
+		BottomArea.BeginWidget();
+
 		FTexture *tex;
 		if(presentKeys & (1<<i))
 			tex = TexMan(Keys[i+1]);
@@ -261,14 +263,12 @@ void BlakeStatusBar::DrawStatusBar()
 		stw = tex->GetScaledWidthDouble();
 		sth = tex->GetScaledHeightDouble();
 		screen->VirtualToRealCoords(stx, sty, stw, sth, 320, 200, true, true);
-		screen->DrawTexture(tex, stx, sty,
-			DTA_DestWidthF, stw,
-			DTA_DestHeightF, sth,
-			TAG_DONE);
+		BottomArea.AddGraphic(tex, stx, sty, stw, sth);
 	}
+	BottomArea.Finish();
 }
 
-void BlakeStatusBar::DrawString(FFont *font, const char* string, double x, double y, bool shadow, EColorRange color, bool center) const
+void BlakeStatusBar::DrawString(FRetainedArea &area, FFont *font, const char* string, double x, double y, bool shadow, EColorRange color, bool center) const
 {
 	word strWidth, strHeight;
 	VW_MeasurePropString(font, string, strWidth, strHeight);
@@ -299,20 +299,12 @@ void BlakeStatusBar::DrawString(FFont *font, const char* string, double x, doubl
 			{
 				tx = x + 1, ty = y + 1, tw = tex->GetScaledWidthDouble(), th = tex->GetScaledHeightDouble();
 				screen->VirtualToRealCoords(tx, ty, tw, th, 320, 200, true, true);
-				screen->DrawTexture(tex, tx, ty,
-					DTA_DestWidthF, tw,
-					DTA_DestHeightF, th,
-					DTA_FillColor, GPalette.BlackIndex,
-					TAG_DONE);
+				area.AddGraphic(tex, tx, ty, tw, th, NULL, GPalette.BlackIndex);
 			}
 
 			tx = x, ty = y, tw = tex->GetScaledWidthDouble(), th = tex->GetScaledHeightDouble();
 			screen->VirtualToRealCoords(tx, ty, tw, th, 320, 200, true, true);
-			screen->DrawTexture(tex, tx, ty,
-				DTA_DestWidthF, tw,
-				DTA_DestHeightF, th,
-				DTA_Translation, remap,
-				TAG_DONE);
+			area.AddGraphic(tex, tx, ty, tw, th, remap);
 		}
 		x += chWidth;
 	}
@@ -51,6 +51,7 @@
 #include "r_data/colormaps.h"
 #include "wl_agent.h"
 #include "wl_def.h"
+#include "wl_draw.h"
 #include "wl_play.h"
 #include "xs_Float.h"
 #include "thingdef/thingdef.h"
@@ -1061,6 +1062,7 @@ std::uint16_t BlakeAOGStatusBar::TP_VALUE(const char* ptr, std::int8_t num_nybbl
 
 void BlakeAOGStatusBar::ScaleSprite2D(FTexture *tex, int xcenter, int topoffset, unsigned height)
 {
+	R_SyncRefresh();
 	auto vbuf = screen->GetBuffer();
 	auto vbufPitch = screen->GetPitch();
 
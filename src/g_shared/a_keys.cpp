@@ -298,7 +298,7 @@ static void ParseLock(Scanner &sc)
 			for (;;)
 			{
 				sc.MustGetToken(TK_StringConst);
-				lock->locksound.Push(SoundInfo.FindSound(sc->str));
+				lock->locksound.Push(SoundInfo.FindSound(SCString_GetChars(sc->str)));
 				if (!sc.CheckToken(','))
 				{
 					break;
@@ -100,16 +100,16 @@ public:
 
 	void DrawStatusBar();
 	unsigned int GetHeight(bool top) { return top ? 0 : STATUSLINES+!mac; }
-	void NewGame() { facecount = 0; }
+	void NewGame() { facecount = 0; retained.Invalidate(); }
 	void RefreshBackground(bool noborder);
 	void UpdateFace(int damage=0);
 	void WeaponGrin();
 
 private:
-	static void LatchNumber (int x, int y, unsigned width, int32_t number, bool zerofill, bool cap=false);
-	static void LatchString (int x, int y, unsigned width, const FString &str);
-	static void StatusDrawFace(FTexture *pic);
-	static void StatusDrawPic(unsigned x, unsigned y, const char* pic);
+	void LatchNumber (int x, int y, unsigned width, int32_t number, bool zerofill, bool cap=false);
+	void LatchString (int x, int y, unsigned width, const FString &str);
+	void StatusDrawFace(FTexture *pic);
+	void StatusDrawPic(unsigned x, unsigned y, const char* pic);
 
 	FTextureID GetArmorIcon (int &points);
 
@@ -126,6 +126,7 @@ private:
 	void DrawArmorPoints();
 	void SetupStatusbar();
 
+	FRetainedArea retained;
 	int facecount;
 	bool mac;
 };
@@ -142,12 +143,12 @@ DBaseStatusBar *CreateStatusBar_Wolf3D() { return new WolfStatusBar(); }
 
 void WolfStatusBar::StatusDrawPic (unsigned x, unsigned y, const char* pic)
 {
-	VWB_DrawGraphic(TexMan(pic), x, 200-(STATUSLINES-y));
+	retained.AddGraphic(TexMan(pic), x, 200-(STATUSLINES-y));
 }
 
 void WolfStatusBar::StatusDrawFace(FTexture *pic)
 {
-	VWB_DrawGraphic(pic, StatusBarConfig.Mugshot.X, 200-(STATUSLINES-StatusBarConfig.Mugshot.Y));
+	retained.AddGraphic(pic, StatusBarConfig.Mugshot.X, 200-(STATUSLINES-StatusBarConfig.Mugshot.Y));
 }
 
 
@@ -325,7 +326,7 @@ void WolfStatusBar::LatchString (int x, int y, unsigned width, const FString &st
 	FRemapTable *remap = HudFont->GetColorTranslation(CR_UNTRANSLATED);
 	for(unsigned int i = MAX<int>(0, (int)(str.Len()-width));i < str.Len();++i)
 	{
-		VWB_DrawGraphic(HudFont->GetChar(str[i], &cwidth), x, y, MENU_NONE, remap);
+		retained.AddGraphic(HudFont->GetChar(str[i], &cwidth), x, y, remap);
 		x += cwidth;
 	}
 }
@@ -468,7 +469,7 @@ void WolfStatusBar::DrawWeapon (void)
 	)
 		return;
 
-	VWB_DrawGraphic(TexMan(players[ConsolePlayer].ReadyWeapon->icon), StatusBarConfig.Weapon.X, 200-(STATUSLINES-StatusBarConfig.Weapon.Y));
+	retained.AddGraphic(TexMan(players[ConsolePlayer].ReadyWeapon->icon), StatusBarConfig.Weapon.X, 200-(STATUSLINES-StatusBarConfig.Weapon.Y));
 }
 
 /*
@@ -489,7 +490,7 @@ void WolfStatusBar::DrawArmor (void)
 	)
 		return;
 
-	VWB_DrawGraphic(TexMan(armorIcon), StatusBarConfig.Armor.X, 200-(STATUSLINES-StatusBarConfig.Armor.Y));
+	retained.AddGraphic(TexMan(armorIcon), StatusBarConfig.Armor.X, 200-(STATUSLINES-StatusBarConfig.Armor.Y));
 }
 
 /*
@@ -603,18 +604,32 @@ void WolfStatusBar::DrawStatusBar()
 	if(viewsize == 21 && ingame)
 		return;
 
-	VWB_DrawGraphic(TexMan("STBAR"), 0, 160);
+	// The widgets only record what they would draw, the retained area then
+	// repaints whichever of them changed since the last frame.
+	retained.Begin(TexMan("STBAR"), 0, 160);
+	retained.BeginWidget();
 	DrawFace ();
+	retained.BeginWidget();
 	DrawHealth ();
+	retained.BeginWidget();
 	DrawLives ();
+	retained.BeginWidget();
 	DrawLevel ();
+	retained.BeginWidget();
 	DrawAmmo ();
+	retained.BeginWidget();
 	DrawKeys ();
+	retained.BeginWidget();
 	DrawWeapon ();
+	retained.BeginWidget();
 	DrawArmor ();
+	retained.BeginWidget();
 	DrawArmorPoints ();
+	retained.BeginWidget();
 	DrawScore ();
+	retained.BeginWidget();
 	DrawItems ();
+	retained.Finish();
 
 	DrawActors ();
 }
@@ -56,10 +56,13 @@ const FName SpecialThingNames[SMT_NumThings] = {
 	"$Player1Start"
 };
 
-GameMap::GameMap(const FString &map) : map(map), valid(false), isUWMF(false),
+unsigned int GameMap::ChangeGeneration = 0;
+
+GameMap::GameMap(const FString &map) : allSpotsChanged(true), map(map), valid(false), isUWMF(false),
 	file(NULL), zoneTraversed(NULL), zoneLinks(NULL)
 {
 	lumps[0] = NULL;
+	MarkChanged();
 
 	// Find the map
 	markerLump = Wads.CheckNumForName(map);
@@ -195,7 +198,10 @@ GameMap::~GameMap()
 		delete file;
 
 	for(unsigned int i = 0;i < planes.Size();++i)
+	{
 		delete[] planes[i].map;
+		delete[] planes[i].spotFlags;
+	}
 	UnloadLinks();
 }
 
@@ -219,13 +225,14 @@ bool GameMap::ActivateTrigger(Trigger &trig, Trigger::Side direction, AActor *ac
 
 void GameMap::ClearVisibility()
 {
-	for(unsigned int i = 0;i < header.width*header.height;++i)
+	for(unsigned int p = 0;p < planes.Size();++p)
 	{
-		for(unsigned int p = 0;p < planes.Size();++p)
-			planes[p].map[i].visible = false;
+		BYTE *flags = planes[p].spotFlags;
+		for(unsigned int i = 0;i < header.width*header.height;++i)
+			flags[i] &= ~SPOT_Visible;
 	}
 	if(players[ConsolePlayer].camera)
-		GetSpot(players[ConsolePlayer].camera->tilex, players[ConsolePlayer].camera->tiley, 0)->visible = true;
+		GetSpot(players[ConsolePlayer].camera->tilex, players[ConsolePlayer].camera->tiley, 0)->SetVisible();
 }
 
 bool GameMap::CheckMapExists(const FString &map)
@@ -416,6 +423,8 @@ GameMap::Plane &GameMap::NewPlane()
 	Plane &newPlane = planes[planes.Size()-1];
 	newPlane.gm = this;
 	newPlane.map = new Plane::Map[header.width*header.height];
+	newPlane.spotFlags = new BYTE[header.width*header.height];
+	memset(newPlane.spotFlags, 0, header.width*header.height);
 	for(unsigned int i = 0;i < header.width*header.height;++i)
 		newPlane.map[i].plane = &newPlane;
 	return newPlane;
@@ -650,6 +659,53 @@ void GameMap::Plane::Map::SetTile(const MapTile *tile)
 			texture[i].SetInvalid();
 		}
 	}
+	UpdateFlags();
+}
+
+// Recomputes the compact flags from the spot. Should be called whenever the
+// tile or push wall state changes.
+void GameMap::Plane::Map::UpdateFlags()
+{
+	BYTE &flags = Flags();
+	flags &= SPOT_Visible;
+	if(tile)
+	{
+		flags |= SPOT_Tile;
+		if(tile->offsetVertical)
+			flags |= SPOT_DoorVertical;
+		if(tile->offsetHorizontal)
+			flags |= SPOT_DoorHorizontal;
+	}
+	if(pushAmount != 0 || pushReceptor)
+		flags |= SPOT_Pushwall;
+	if(amFlags & AM_Visible)
+		flags |= SPOT_Mapped;
+	MarkChanged();
+	plane->gm->SpotChanged(this);
+}
+
+void GameMap::SpotChanged(const Plane::Map *spot) const
+{
+	if(allSpotsChanged || planes.Size() == 0 || spot->plane != &planes[0])
+		return;
+
+	// Past a point it's cheaper to take the whole map again.
+	if(changedSpots.Size() >= header.width*header.height/4)
+	{
+		allSpotsChanged = true;
+		changedSpots.Clear();
+		return;
+	}
+	changedSpots.Push(static_cast<unsigned int>(spot - planes[0].map));
+}
+
+bool GameMap::TakeChangedSpots(TArray<unsigned int> &spots) const
+{
+	const bool all = allSpotsChanged;
+	spots = changedSpots;
+	changedSpots.Clear();
+	allSpotsChanged = false;
+	return !all;
 }
 
 FArchive &operator<< (FArchive &arc, GameMap *&gm)
@@ -723,8 +779,9 @@ FArchive &operator<< (FArchive &arc, GameMap *&gm)
 			arc << pushdir;
 			plane.map[i].pushDirection = static_cast<MapTile::Side>(pushdir);
 
+			bool visible = plane.map[i].IsVisible();
 			arc << plane.map[i].texture[0] << plane.map[i].texture[1] << plane.map[i].texture[2] << plane.map[i].texture[3]
-				<< plane.map[i].visible;
+				<< visible;
 			if(GameSave::SaveVersion >= 1393719642)
 				arc << plane.map[i].amFlags;
 			arc << plane.map[i].thinker
@@ -741,7 +798,12 @@ FArchive &operator<< (FArchive &arc, GameMap *&gm)
 				arc << plane.map[i].slideStyle;
 
 			if(!arc.IsStoring())
+			{
 				plane.map[i].plane = &plane;
+				plane.map[i].UpdateFlags();
+				if(visible)
+					plane.map[i].SetVisible();
+			}
 		}
 	}
 
@@ -62,6 +62,18 @@ enum
 	AM_DontOverlay = 0x2
 };
 
+// Compact per spot flags kept parallel to the plane map so that the ray
+// caster and line of sight checks don't need to touch the full spot.
+enum
+{
+	SPOT_Tile = 0x1,
+	SPOT_DoorVertical = 0x2,
+	SPOT_DoorHorizontal = 0x4,
+	SPOT_Pushwall = 0x8,
+	SPOT_Visible = 0x10,
+	SPOT_Mapped = 0x20 // AM_Visible already set in amFlags
+};
+
 class GameMap
 {
 	public:
@@ -189,7 +201,6 @@ class GameMap
 			struct Map
 			{
 				Map() : tile(NULL), sector(NULL), zone(NULL), lightsector(NULL),
-					visible(false),
 					amFlags(0), thinker(NULL), slideStyle(0),
 					pushDirection(Tile::East), pushAmount(0),
 					pushReceptor(NULL), tag(0), nexttag(NULL)
@@ -202,6 +213,18 @@ class GameMap
 				unsigned int	GetY() const;
 				Map				*GetAdjacent(Tile::Side dir, bool opposite=false) const;
 				void			SetTile(const Tile *tile);
+				void			UpdateFlags();
+				BYTE			&Flags() const { return plane->spotFlags[this - plane->map]; }
+				bool			IsVisible() const { return (Flags() & SPOT_Visible) != 0; }
+				void			SetVisible() { Flags() |= SPOT_Visible; }
+				void			SetMapped()
+				{
+					if(!(amFlags & AM_Visible))
+					{
+						amFlags |= AM_Visible;
+						GameMap::MarkChanged();
+					}
+				}
 
 				const Plane		*plane;
 
@@ -213,7 +236,6 @@ class GameMap
 				// So that the textures can change.
 				FTextureID		texture[4];
 
-				bool			visible;
 				unsigned int	amFlags;
 				TObjPtr<Thinker> thinker;
 				unsigned int	slideAmount[4];
@@ -227,6 +249,7 @@ class GameMap
 				unsigned int	tag;
 				Plane::Map		*nexttag;
 			}*	map;
+			BYTE			*spotFlags;
 		};
 
 		GameMap(const FString &map);
@@ -239,6 +262,7 @@ class GameMap
 		int				GetMarketLumpNum() const { return markerLump; }
 		Plane::Map		*GetSpot(unsigned int x, unsigned int y, unsigned int z) const { return &GetPlane(z).map[y*header.width+x]; }
 		Plane::Map		*GetSpotByTag(unsigned int tag, Plane::Map *start) const;
+		BYTE			GetSpotFlags(unsigned int x, unsigned int y, unsigned int z) const { return GetPlane(z).spotFlags[y*header.width+x]; }
 		const Zone		&GetZone(unsigned int index) { return zonePalette[index]; }
 		bool			IsValid() const { return valid; }
 		bool			IsValidTileCoordinate(unsigned int x, unsigned int y, unsigned int z) const { return x < header.width && y < header.height && z < NumPlanes(); }
@@ -252,6 +276,17 @@ class GameMap
 		void			ActivateWallSwitch(int barrier_code);
 		void			SetMusic(const FString& music) { header.music = music; }
 
+		// Bumped whenever something the automap draws changes so that it
+		// only needs to redraw the tiles when this differs.
+		static unsigned int	GetChangeGeneration() { return ChangeGeneration; }
+		static void		MarkChanged() { ++ChangeGeneration; }
+
+		// Lists the spots on the first plane whose tile, sector or zone
+		// changed so the renderer can keep its copy of them up to date.
+		// TakeChangedSpots returns false if everything has to be taken again.
+		void			SpotChanged(const Plane::Map *spot) const;
+		bool			TakeChangedSpots(TArray<unsigned int> &spots) const;
+
 		// Sound functions
 		bool			CheckLink(const Zone *zone1, const Zone *zone2, bool recurse);
 		void			LinkZones(const Zone *zone1, const Zone *zone2, bool open);
@@ -290,6 +325,10 @@ class GameMap
 		int		SpawnConcession(std::uint16_t credits, std::uint16_t machinetype);
 		int		SpawnWallSwitch(std::uint16_t oldnum, std::uint16_t oldnum2, int x, int y);
 
+		static unsigned int ChangeGeneration;
+		mutable TArray<unsigned int> changedSpots;
+		mutable bool allSpotsChanged;
+
 		FString	map;
 
 		bool	valid;
@@ -708,7 +708,31 @@ private:
 	FTextureID flatTable[256][2]; // Floor/ceiling textures
 	EFeatureFlags FeatureFlags;
 };
-static Xlat xlat;
+static TArray<TUniquePtr<Xlat> > xlatCache;
+static TArray<FString> xlatCacheKeys;
+static Xlat *xlat = NULL;
+
+// Translators are parsed once per session and kept by the lump name and the
+// translator stack used for any "$base" includes, so going back and forth
+// between maps with different translators doesn't rescan them.
+static Xlat *GetXlat(const FString &baseLumpName, const GameInfo::FStringStack *baseStack)
+{
+	FString key = baseLumpName;
+	for(;baseStack;baseStack = baseStack->Next())
+		key.AppendFormat("\n%s", baseStack->str.GetChars());
+
+	for(unsigned int i = 0;i < xlatCacheKeys.Size();++i)
+	{
+		if(xlatCacheKeys[i].CompareNoCase(key) == 0)
+			return xlatCache[i];
+	}
+
+	TUniquePtr<Xlat> newXlat(new Xlat());
+	newXlat->LoadXlat(baseLumpName, baseStack);
+
+	xlatCacheKeys.Push(key);
+	return xlatCache[xlatCache.Push(newXlat)];
+}
 
 static int FindAdjacentDoor(MapSpot spot, MapTrigger *&trigger);
 
@@ -916,7 +940,7 @@ void GameMap::ReadMacData()
 		uint32_t flags = 0;
 		uint32_t tsFlags = 0;
 
-		if((tsFlags = xlat.TranslateThing(thing, trigger, flags, type)) == 0)
+		if((tsFlags = xlat->TranslateThing(thing, trigger, flags, type)) == 0)
 			printf("Unknown old type %d @ (%d,%d)\n", type, x, y);
 		else
 		{
@@ -973,11 +997,11 @@ void GameMap::ReadPlanesData()
 	enum OldPlanes { Plane_Tiles, Plane_Object, Plane_Flats, Plane_Info, Plane_LightCells, NUM_USABLE_PLANES };
 
 	if(levelInfo->Translator.IsEmpty())
-		xlat.LoadXlat(gameinfo.Translator.str, gameinfo.Translator.Next());
+		xlat = GetXlat(gameinfo.Translator.str, gameinfo.Translator.Next());
 	else
-		xlat.LoadXlat(levelInfo->Translator, &gameinfo.Translator);
+		xlat = GetXlat(levelInfo->Translator, &gameinfo.Translator);
 
-	Xlat::EFeatureFlags FeatureFlags = xlat.GetFeatureFlags();
+	Xlat::EFeatureFlags FeatureFlags = xlat->GetFeatureFlags();
 	sectorPalette.Clear();
 	lightSectorPalette.Clear();
 
@@ -1124,10 +1148,10 @@ void GameMap::ReadPlanesData()
 
 			case Plane_Tiles:
 			{
-				WORD tileStart = xlat.GetTilePalette(tilePalette);
+				WORD tileStart = xlat->GetTilePalette(tilePalette);
 				init_switch_dest(tilePalette);
 
-				xlat.GetZonePalette(zonePalette);
+				xlat->GetZonePalette(zonePalette);
 
 				TArray<WORD> fillSpots;
 				TMap<WORD, Xlat::ModZone> changeTriggerSpots;
@@ -1139,13 +1163,13 @@ void GameMap::ReadPlanesData()
 				{
 					oldplane[i] = LittleShort(oldplane[i]);
 
-					if(xlat.IsValidTile(oldplane[i]))
+					if(xlat->IsValidTile(oldplane[i]))
 						mapPlane.map[i].SetTile(&tilePalette[oldplane[i]-tileStart]);
 					else
 						mapPlane.map[i].SetTile(NULL);
 
 					Xlat::ModZone zone;
-					if(xlat.GetModZone(oldplane[i], zone))
+					if(xlat->GetModZone(oldplane[i], zone))
 					{
 						if(zone.fillZone)
 							fillSpots.Push(i);
@@ -1162,7 +1186,7 @@ void GameMap::ReadPlanesData()
 					}
 
 					MapTrigger templateTrigger;
-					if(xlat.TranslateTileTrigger(oldplane[i], templateTrigger))
+					if(xlat->TranslateTileTrigger(oldplane[i], templateTrigger))
 					{
 						templateTrigger.x = i%header.width;
 						templateTrigger.y = i/header.width;
@@ -1180,7 +1204,7 @@ void GameMap::ReadPlanesData()
 					}
 
 					int zoneIndex;
-					if((zoneIndex = xlat.TranslateZone(oldplane[i])) != -1)
+					if((zoneIndex = xlat->TranslateZone(oldplane[i])) != -1)
 						mapPlane.map[i].zone = &zonePalette[zoneIndex];
 					else
 						mapPlane.map[i].zone = NULL;
@@ -1350,8 +1374,8 @@ void GameMap::ReadPlanesData()
 								{
 									canUseFlatColor = false;
 									gotFlatTextures = true;
-									defaultCeiling = xlat.TranslateFlat(oldplane[++i]>>8, Sector::Ceiling, levelInfo->DefaultTexture[Sector::Ceiling]);
-									defaultFloor = xlat.TranslateFlat(oldplane[i]&0xFF, Sector::Floor, levelInfo->DefaultTexture[Sector::Floor]);
+									defaultCeiling = xlat->TranslateFlat(oldplane[++i]>>8, Sector::Ceiling, levelInfo->DefaultTexture[Sector::Ceiling]);
+									defaultFloor = xlat->TranslateFlat(oldplane[i]&0xFF, Sector::Floor, levelInfo->DefaultTexture[Sector::Floor]);
 
 									sectorPalette.Resize(1);
 									continue;
@@ -1384,7 +1408,7 @@ void GameMap::ReadPlanesData()
 					uint32_t flags = 0;
 					uint32_t tsFlags = 0;
 
-					if((tsFlags = xlat.TranslateThing(thing, trigger, flags, oldplane[i])) == 0)
+					if((tsFlags = xlat->TranslateThing(thing, trigger, flags, oldplane[i])) == 0)
 						printf("Unknown old type %d @ (%d,%d)\n", oldplane[i], i%header.width, i/header.width);
 					else
 					{
@@ -1464,10 +1488,10 @@ void GameMap::ReadPlanesData()
 				while(iter.NextPair(pair))
 				{
 					Sector &sect = sectorPalette[pair->Value];
-					sect.texture[Sector::Floor] = xlat.TranslateFlat(pair->Key&0xFF, Sector::Floor, defaultFloor);
+					sect.texture[Sector::Floor] = xlat->TranslateFlat(pair->Key&0xFF, Sector::Floor, defaultFloor);
 
 					FTextureID ceilid = lvlHasParallax ? FNullTextureID() : defaultCeiling;
-					sect.texture[Sector::Ceiling] = xlat.TranslateFlat(pair->Key>>8, Sector::Ceiling, ceilid);
+					sect.texture[Sector::Ceiling] = xlat->TranslateFlat(pair->Key>>8, Sector::Ceiling, ceilid);
 				}
 
 				// Now link the sector data to map points!
@@ -1518,7 +1542,7 @@ void GameMap::ReadPlanesData()
 	{
 		if((infoplane[i]&0xFF00) == 0xBA00)
 		{
-			FString music = xlat.GetMusic(infoplane[i]&0xFF);
+			FString music = xlat->GetMusic(infoplane[i]&0xFF);
 			if(music.IsNotEmpty())
 			{
 				header.music = music;
@@ -1668,7 +1692,7 @@ void GameMap::ReadPlanesData()
 
 void GameMap::ChangeMusic(int selection)
 {
-	FString music = xlat.GetMusic(selection);
+	FString music = xlat ? xlat->GetMusic(selection) : FString();
 	header.music = music;
 }
 
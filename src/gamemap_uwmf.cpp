@@ -32,13 +32,20 @@
 **
 */
 
+#include <cstdio>
+
+#include "doomerrors.h"
+#include "farchive.h"
+#include "filesys.h"
 #include "gamemap.h"
 #include "gamemap_common.h"
 #include "g_mapinfo.h"
 #include "id_ca.h"
 #include "lnspec.h"
+#include "m_crc32.h"
 #include "scanner.h"
 #include "thingdef/thingdef.h"
+#include "version.h"
 #include "w_wad.h"
 #include "wl_game.h"
 #include "wl_shade.h"
@@ -327,25 +334,274 @@ void TextMapParser::ParseLightSector(Scanner &sc, MapLightSector &lightsector)
 	EndParseBlock
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//
+// Compiled maps
+//
+// Tokenizing a large TEXTMAP is the slowest part of entering a UWMF level, so
+// the parsed result is archived to the cache directory the first time a map is
+// seen.  Files are named after the CRC and size of the TEXTMAP lump.  Textures
+// and names are stored by name and resolved again on load.  Only what the
+// TEXTMAP itself says is stored, MAPINFO defaults are applied on top each time.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+static const DWORD COMPILEDMAP_VERSION = 2;
+
+// The cache directory is writable by anything so nothing in a compiled map is
+// trusted beyond these.  Maps that don't fit are simply not cached.
+static const unsigned int COMPILEDMAP_MAXSPOTS = 0x1000000;
+static const unsigned int COMPILEDMAP_MAXENTRIES = 0x100000;
+static const unsigned int COMPILEDMAP_MAXPLANES = 0x100;
+
+static FString GetCompiledMapPath(DWORD crc, long size)
+{
+	FString path;
+	path.Format("%s" PATH_SEPARATOR "%08X%08lX.wmc", FileSys::GetDirectoryPath(FileSys::DIR_Cache).GetChars(), crc, size);
+	return path;
+}
+
+template<class T>
+static bool ArchiveArray(FArchive &arc, TArray<T> &array, void (*archive)(FArchive &, T &))
+{
+	DWORD count = array.Size();
+	arc << count;
+	if(count > COMPILEDMAP_MAXENTRIES)
+		return false;
+
+	if(arc.IsLoading())
+	{
+		array.Clear();
+		array.Resize(count);
+	}
+	for(unsigned int i = 0;i < count;++i)
+		archive(arc, array[i]);
+	return true;
+}
+
+static void ArchiveTile(FArchive &arc, MapTile &tile)
+{
+	arc << tile.texture[0] << tile.texture[1] << tile.texture[2] << tile.texture[3]
+		<< tile.overhead
+		<< tile.sideSolid[0] << tile.sideSolid[1] << tile.sideSolid[2] << tile.sideSolid[3]
+		<< tile.offsetVertical << tile.offsetHorizontal
+		<< tile.soundSequence
+		<< tile.mapped
+		<< tile.dontOverlay
+		<< tile.showSky
+		<< tile.switchTextureEast
+		<< tile.bright
+		<< tile.decal
+		<< tile.slideStyle
+		<< tile.textureFlip;
+}
+
+static void ArchiveSector(FArchive &arc, MapSector &sector)
+{
+	arc << sector.texture[0] << sector.texture[1] << sector.overhead;
+}
+
+static void ArchiveZone(FArchive &arc, MapZone &zone)
+{
+	// The index is the position in the palette and is set again on load.
+	arc << zone.hintareanum;
+}
+
+static void ArchiveLightSector(FArchive &arc, MapLightSector &lightsector)
+{
+	arc << lightsector.index << lightsector.light;
+}
+
+static void ArchiveThing(FArchive &arc, MapThing &thing)
+{
+	arc << thing.x << thing.y << thing.z
+		<< thing.type
+		<< thing.angle
+		<< thing.ambush << thing.patrol << thing.holo;
+	for(unsigned int i = 0;i < 4;++i)
+		arc << thing.skill[i];
+	for(unsigned int i = 0;i < MapThing::MAXHUBPASSES;++i)
+		arc << thing.hubnospawn[i];
+}
+
+static void ArchiveTrigger(FArchive &arc, MapTrigger &trigger)
+{
+	arc << trigger.x << trigger.y << trigger.z
+		<< trigger.active
+		<< trigger.action
+		<< trigger.activate[0] << trigger.activate[1] << trigger.activate[2] << trigger.activate[3]
+		<< trigger.arg[0] << trigger.arg[1] << trigger.arg[2] << trigger.arg[3] << trigger.arg[4]
+		<< trigger.playerUse
+		<< trigger.playerCross
+		<< trigger.monsterUse
+		<< trigger.monsterUseFilter
+		<< trigger.isSecret
+		<< trigger.repeatable
+		<< trigger.infoMessage
+		<< trigger.onSpawnAction;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 class UWMFParser : public TextMapParser
 {
+	protected:
+		struct PMData
+		{
+			int tile;
+			int sector;
+			int zone;
+			int tag;
+			int lightsector;
+		};
+
 	public:
-		UWMFParser(GameMap *gm, Scanner &sc) : gm(gm), sc(sc)
+		// Everything taken from the TEXTMAP, kept apart from the GameMap so
+		// that it can be archived and so that a bad compiled map can be thrown
+		// away without leaving the level half loaded.
+		class CompiledMap
+		{
+			public:
+				CompiledMap() { Clear(); }
+				~CompiledMap() { Clear(); }
+
+				void Clear()
+				{
+					header.name = FString();
+					header.width = 64;
+					header.height = 64;
+					header.tileSize = 64;
+					hasLight = false;
+					light = 0;
+					hasVisibility = false;
+					visibility = 0;
+					tilePalette.Clear();
+					sectorPalette.Clear();
+					zonePalette.Clear();
+					lightSectorPalette.Clear();
+					things.Clear();
+					planeDepths.Clear();
+					for(unsigned int i = 0;i < data.Size();++i)
+						delete[] data[i];
+					data.Clear();
+					triggers.Clear();
+				}
+
+				GameMap::Header header;
+				bool hasLight;
+				int light;
+				bool hasVisibility;
+				fixed visibility;
+				TArray<MapTile> tilePalette;
+				TArray<MapSector> sectorPalette;
+				TArray<MapZone> zonePalette;
+				TArray<MapLightSector> lightSectorPalette;
+				TArray<MapThing> things;
+				TArray<unsigned int> planeDepths;
+				TArray<PMData*> data;
+				TArray<MapTrigger> triggers;
+
+			private:
+				CompiledMap(const CompiledMap &);
+				const CompiledMap &operator= (const CompiledMap &);
+		};
+
+		UWMFParser(CompiledMap &map, Scanner &sc) : map(map), sc(sc), cacheable(true)
 		{
 		}
-		~UWMFParser()
+
+		bool IsCacheable() const { return cacheable; }
+
+		// Returns false if the compiled map is missing, out of date, or
+		// damaged, in which case the TEXTMAP needs to be parsed.  The map is
+		// left empty on failure.
+		static bool LoadCompiled(const FString &filename, CompiledMap &map)
 		{
-			for(unsigned int i = 0;i < data.Size();++i)
-				delete[] data[i];
+			FILE *file = File(filename).open("rb");
+			if(!file)
+				return false;
+
+			try
+			{
+				FCompressedFile in(file, FFile::EReading);
+				if(!in.IsOpen())
+					return false;
+
+				FArchive arc(in);
+				DWORD version;
+				FString engineVersion;
+				arc << version << engineVersion;
+				if(version != COMPILEDMAP_VERSION || engineVersion.Compare(GetVersionHash()) != 0)
+					return false;
+
+				if(ArchiveMap(arc, map))
+					return true;
+			}
+			catch(CRecoverableError &)
+			{
+				// Truncated file
+			}
+
+			Printf("Ignoring damaged compiled map %s.\n", filename.GetChars());
+			map.Clear();
+			return false;
+		}
+
+		static void SaveCompiled(const FString &filename, CompiledMap &map)
+		{
+			// Write to a temporary file so that an interrupted write doesn't
+			// leave a truncated map behind.
+			const FString tempname = filename + ".tmp";
+			FILE *file = File(tempname).open("wb");
+			if(!file)
+				return;
+
+			bool written;
+			{
+				FCompressedFile out(file, FFile::EWriting);
+				FArchive arc(out);
+				DWORD version = COMPILEDMAP_VERSION;
+				FString engineVersion = GetVersionHash();
+				arc << version << engineVersion;
+				written = ArchiveMap(arc, map);
+			}
+
+			if(written)
+				remove(filename);
+			if(!written || rename(tempname, filename) != 0)
+				remove(tempname);
+		}
+
+		// Builds the level from the compiled map.  The MAPINFO lighting has
+		// already been set up so only the TEXTMAP's own overrides apply.
+		static void Install(GameMap *gm, const CompiledMap &map)
+		{
+			gm->header.name = map.header.name;
+			gm->header.width = map.header.width;
+			gm->header.height = map.header.height;
+			gm->header.tileSize = map.header.tileSize;
+
+			if(map.hasLight)
+				gLevelLight = map.light;
+			if(map.hasVisibility)
+				gLevelVisibility = map.visibility;
+
+			gm->tilePalette = map.tilePalette;
+			gm->sectorPalette = map.sectorPalette;
+			gm->zonePalette = map.zonePalette;
+			gm->lightSectorPalette = map.lightSectorPalette;
+			gm->things = map.things;
+
+			for(unsigned int i = 0;i < map.planeDepths.Size();++i)
+				gm->NewPlane().depth = map.planeDepths[i];
+
+			InstallPlanes(gm, map.data, map.triggers);
 		}
 
 		void Parse()
 		{
 			bool ecwolf12Namespace = false;
 			bool canChangeHeader = true;
-			gm->header.width = 64;
-			gm->header.height = 64;
-			gm->header.tileSize = 64;
 
 			while(sc.TokensLeft())
 			{
@@ -364,26 +620,26 @@ class UWMFParser : public TextMapParser
 					else CheckKey("tilesize")
 					{
 						sc.MustGetToken(TK_IntConst);
-						gm->header.tileSize = sc->number;
+						map.header.tileSize = sc->number;
 					}
 					else CheckKey("name")
 					{
 						sc.MustGetToken(TK_StringConst);
-						gm->header.name = sc->str;
+						map.header.name = sc->str;
 					}
 					else CheckKey("width")
 					{
 						if(!canChangeHeader)
 							sc.ScriptMessage(Scanner::ERROR, "Changing dimensions after dependent data.\n");
 						sc.MustGetToken(TK_IntConst);
-						gm->header.width = sc->number;
+						map.header.width = sc->number;
 					}
 					else CheckKey("height")
 					{
 						if(!canChangeHeader)
 							sc.ScriptMessage(Scanner::ERROR, "Changing dimensions after dependent data.\n");
 						sc.MustGetToken(TK_IntConst);
-						gm->header.height = sc->number;
+						map.header.height = sc->number;
 					}
 					// Defaultlightlevel and defaultvisibility may be merged
 					// into the UWMF spec once the values from ROTT are set in
@@ -393,14 +649,16 @@ class UWMFParser : public TextMapParser
 						if(!ecwolf12Namespace)
 							sc.ScriptMessage(Scanner::WARNING, "Setting defaultlightlevel on Wolf3D namespace not standard, use ECWolf-v12\n");
 						sc.MustGetToken(TK_IntConst);
-						gLevelLight = sc->number;
+						map.hasLight = true;
+						map.light = sc->number;
 					}
 					else CheckKey("defaultvisibility")
 					{
 						if(!ecwolf12Namespace)
 							sc.ScriptMessage(Scanner::WARNING, "Setting defaultvisibility on Wolf3D namespace not standard, use ECWolf-v12\n");
 						sc.MustGetToken(TK_FloatConst);
-						gLevelVisibility = static_cast<fixed>(sc->decimal*LIGHTVISIBILITY_FACTOR*65536.);
+						map.hasVisibility = true;
+						map.visibility = static_cast<fixed>(sc->decimal*LIGHTVISIBILITY_FACTOR*65536.);
 					}
 					else
 						sc.GetNextToken();
@@ -436,17 +694,83 @@ class UWMFParser : public TextMapParser
 				else
 					sc.ScriptMessage(Scanner::ERROR, "Unable to parse TEXTMAP, invalid syntax.\n");
 			}
-
-			InstallPlanes();
 		}
 
 	protected:
-		void InstallPlanes()
+		static void ArchivePlaneMap(FArchive &arc, PMData *pdata, unsigned int size)
+		{
+			for(unsigned int i = 0;i < size;++i)
+			{
+				arc << pdata[i].tile << pdata[i].sector << pdata[i].zone
+					<< pdata[i].tag << pdata[i].lightsector;
+			}
+		}
+
+		// Returns false if the map is beyond the limits of a compiled map.
+		// When loading the map may be partially filled in at that point.
+		static bool ArchiveMap(FArchive &arc, CompiledMap &map)
+		{
+			arc << map.header.name
+				<< map.header.width
+				<< map.header.height
+				<< map.header.tileSize
+				<< map.hasLight << map.light
+				<< map.hasVisibility << map.visibility;
+
+			if(map.header.width == 0 || map.header.height == 0 ||
+				map.header.width > COMPILEDMAP_MAXSPOTS/map.header.height)
+				return false;
+
+			if(!ArchiveArray(arc, map.tilePalette, ArchiveTile) ||
+				!ArchiveArray(arc, map.sectorPalette, ArchiveSector) ||
+				!ArchiveArray(arc, map.zonePalette, ArchiveZone) ||
+				!ArchiveArray(arc, map.lightSectorPalette, ArchiveLightSector) ||
+				!ArchiveArray(arc, map.things, ArchiveThing) ||
+				!ArchiveArray(arc, map.triggers, ArchiveTrigger))
+				return false;
+
+			DWORD numPlanes = map.planeDepths.Size();
+			arc << numPlanes;
+			if(numPlanes > COMPILEDMAP_MAXPLANES)
+				return false;
+			if(arc.IsLoading())
+				map.planeDepths.Resize(numPlanes);
+			for(unsigned int i = 0;i < numPlanes;++i)
+				arc << map.planeDepths[i];
+
+			const unsigned int size = map.header.width*map.header.height;
+			DWORD numPlaneMaps = map.data.Size();
+			arc << numPlaneMaps;
+			if(numPlaneMaps > numPlanes)
+				return false;
+			for(unsigned int i = 0;i < numPlaneMaps;++i)
+			{
+				if(arc.IsLoading())
+					map.data.Push(new PMData[size]);
+				ArchivePlaneMap(arc, map.data[i], size);
+			}
+
+			if(arc.IsLoading())
+			{
+				for(unsigned int i = 0;i < map.zonePalette.Size();++i)
+					map.zonePalette[i].index = i;
+
+				for(unsigned int i = 0;i < map.triggers.Size();++i)
+				{
+					const MapTrigger &trig = map.triggers[i];
+					if(trig.x >= map.header.width || trig.y >= map.header.height || trig.z >= numPlanes)
+						return false;
+				}
+			}
+			return true;
+		}
+
+		static void InstallPlanes(GameMap *gm, const TArray<PMData*> &data, const TArray<MapTrigger> &triggers)
 		{
 			// Transfer data into actual structure with pointers.
 			const unsigned int size = gm->GetHeader().width*gm->GetHeader().height;
 
-			for(unsigned int i = 0;i < data.Size();++i)
+			for(unsigned int i = 0;i < data.Size() && i < gm->planes.Size();++i)
 			{
 				MapPlane &plane = gm->planes[i];
 				PMData* pdata = data[i];
@@ -474,7 +798,7 @@ class UWMFParser : public TextMapParser
 			// Load in the triggers since they can depend on plane data
 			for(unsigned int i = 0;i < triggers.Size();++i)
 			{
-				MapTrigger &src = triggers[i];
+				const MapTrigger &src = triggers[i];
 				MapTrigger &trig = gm->NewTrigger(src.x, src.y, src.z);
 				trig = src;
 
@@ -485,10 +809,10 @@ class UWMFParser : public TextMapParser
 
 		void ParsePlaneMap()
 		{
-			const unsigned int size = gm->GetHeader().width*gm->GetHeader().height;
+			const unsigned int size = map.header.width*map.header.height;
 
 			PMData* pdata = new PMData[size];
-			data.Push(pdata);
+			map.data.Push(pdata);
 			unsigned int i = 0;
 			// Different syntax
 			while(!sc.CheckToken('}'))
@@ -527,16 +851,17 @@ class UWMFParser : public TextMapParser
 
 		void ParsePlane()
 		{
-			MapPlane &plane = gm->NewPlane();
+			unsigned int depth = 0;
 			StartParseBlock
 
 			CheckKey("depth")
 			{
 				sc.MustGetToken(TK_IntConst);
-				plane.depth = sc->number;
+				depth = sc->number;
 			}
 
 			EndParseBlock
+			map.planeDepths.Push(depth);
 		}
 
 		void ParseSector()
@@ -556,7 +881,7 @@ class UWMFParser : public TextMapParser
 			}
 
 			EndParseBlock
-			gm->sectorPalette.Push(sector);
+			map.sectorPalette.Push(sector);
 		}
 
 		void ParseLightSector()
@@ -571,7 +896,7 @@ class UWMFParser : public TextMapParser
 			}
 
 			EndParseBlock
-			gm->lightSectorPalette.Push(lightsector);
+			map.lightSectorPalette.Push(lightsector);
 		}
 
 		void ParseThing()
@@ -611,6 +936,7 @@ class UWMFParser : public TextMapParser
 						sc.ScriptMessage(Scanner::WARNING, "Deprecated use of editor number. Use class name instead.");
 					}
 
+					cacheable = false;
 					if(const ClassDef *cls = ClassDef::FindClass(sc->number))
 						thing.type = cls->GetName();
 					else if(sc->number >= 1 && sc->number <= SMT_NumThings)
@@ -666,7 +992,7 @@ class UWMFParser : public TextMapParser
 			}
 
 			EndParseBlock
-			gm->things.Push(thing);
+			map.things.Push(thing);
 		}
 
 		void ParseTile()
@@ -674,7 +1000,7 @@ class UWMFParser : public TextMapParser
 			MapTile tile;
 			TextMapParser::ParseTile(sc, tile);
 
-			gm->tilePalette.Push(tile);
+			map.tilePalette.Push(tile);
 		}
 
 		void ParseTrigger()
@@ -684,32 +1010,22 @@ class UWMFParser : public TextMapParser
 			MapTrigger trigger;
 			TextMapParser::ParseTrigger(sc, trigger);
 
-			triggers.Push(trigger);
+			map.triggers.Push(trigger);
 		}
 
 		void ParseZone()
 		{
 			MapZone zone;
-			zone.index = gm->zonePalette.Size();
+			zone.index = map.zonePalette.Size();
 
 			TextMapParser::ParseZone(sc, zone);
-			gm->zonePalette.Push(zone);
+			map.zonePalette.Push(zone);
 		}
 
 	private:
-		struct PMData
-		{
-			int tile;
-			int sector;
-			int zone;
-			int tag;
-			int lightsector;
-		};
-
-		GameMap * const gm;
+		CompiledMap &map;
 		Scanner &sc;
-		TArray<PMData*> data;
-		TArray<MapTrigger> triggers;
+		bool cacheable;
 };
 
 void GameMap::ReadUWMFData()
@@ -721,12 +1037,24 @@ void GameMap::ReadUWMFData()
 	long size = lumps[0]->GetLength();
 	char *data = new char[size];
 	lumps[0]->Read(data, size);
-	Scanner sc(data, size);
-	delete[] data;
 
-	// Read TEXTMAP
-	UWMFParser parser(this, sc);
-	parser.Parse();
+	const FString compiledMapPath = GetCompiledMapPath(CalcCRC32((const BYTE*)data, size), size);
+	UWMFParser::CompiledMap compiledMap;
+	if(!UWMFParser::LoadCompiled(compiledMapPath, compiledMap))
+	{
+		Scanner sc(data, size);
+
+		// Read TEXTMAP
+		UWMFParser parser(compiledMap, sc);
+		parser.Parse();
+
+		// Editor numbers depend on the loaded actor definitions, so we
+		// can't safely reuse anything resolved from them.
+		if(parser.IsCacheable())
+			UWMFParser::SaveCompiled(compiledMapPath, compiledMap);
+	}
+	delete[] data;
 
+	UWMFParser::Install(this, compiledMap);
 	SetupLinks();
 }
@@ -27,7 +27,13 @@
 //                      NeedsMusic - load music?
 //
 #include "wl_def.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include <SDL_mixer.h>
+#include "c_cvars.h"
+#include "filesys.h"
+#include "m_crc32.h"
 #include "w_wad.h"
 #include "zstring.h"
 #include "sndinfo.h"
@@ -57,10 +63,103 @@
 
 #define MIN_TICKS_BETWEEN_DIGI_REPEATS 10
 
-// Mutex for thread-safe audio:
-SDL_mutex *audioMutex;
+// Commands from the game thread to SDL_IMFMusicPlayer(). The AdLib, PC
+// speaker and sequencer state is only touched by SDL_ExecAudioCommand() and the
+// audio callback, so the callback never has to wait on the game thread.
+enum EAudioCommand
+{
+	AC_PCPlay,
+	AC_PCStop,
+	AC_PCVolume,
+	AC_ALPlay,
+	AC_ALStop,
+	AC_ALStart,
+	AC_ALShut,
+	AC_MusicCache,
+	AC_MusicStart,
+	AC_MusicOn,
+	AC_MusicOff
+};
+struct AudioCommand
+{
+	EAudioCommand	type;
+	void			*data;
+	int				arg1;
+	int				arg2;
+	unsigned int	serial;
+};
+
+#define AUDIO_QUEUE_SIZE 1024	// Must be a power of 2
+#define AUDIO_QUEUE_TIMEOUT 100	// ms to wait on the audio thread before giving up
+static AudioCommand					audioQueue[AUDIO_QUEUE_SIZE];
+static std::atomic<unsigned int>	audioQueueHead(0);	// Written by the game thread
+static std::atomic<unsigned int>	audioQueueTail(0);	// Written by the consumer
+static bool							imfHooked = false;
+
+static void SDL_SendAudioCommand(EAudioCommand type, void *data=NULL, int arg1=0, int arg2=0, unsigned int serial=0);
+static void SDL_DrainAudioCommands();
+
+globalsoundpos channelSoundPos[SD_MAXVOICES];
+
+// Digitized sounds play on logical voices owned by the engine rather than on
+// SDL_mixer channels. SD_MixVoices() mixes them after SDL_mixer has produced
+// the music. Voices which can't be heard, or which aren't among the
+// SD_MIXVOICES loudest, are virtual: their position advances but they aren't
+// mixed.
+#define SD_MIXVOICES	32
+#define SD_RESERVEDVOICES	(SD_ADLIB+1)
+#define MIX_BLOCK		1024	// Samples mixed per pass, both channels counted
+
+struct SoundVoice
+{
+	Mix_Chunk		*chunk;		// NULL when the voice is free
+	unsigned int	serial;
+	bool			looping;
+	int				leftpos, rightpos, distance;
+	double			volume;
+};
+static SoundVoice	digiVoices[SD_MAXVOICES];
+static unsigned int	digiSerial;
+static bool			voicesHooked = false;
+
+enum EVoiceCommand
+{
+	VC_Start,
+	VC_Stop
+};
+struct VoiceCommand
+{
+	EVoiceCommand	type;
+	int				voice;
+	const Sint16	*data;
+	unsigned int	length;
+	bool			looping;
+	unsigned int	serial;
+};
+
+#define VOICE_QUEUE_SIZE 1024	// Must be a power of 2
+#define VOICE_QUEUE_TIMEOUT 100	// ms to wait for room when the queue is full
+static VoiceCommand					voiceQueue[VOICE_QUEUE_SIZE];
+static std::atomic<unsigned int>	voiceQueueHead(0);	// Written by the game thread
+static std::atomic<unsigned int>	voiceQueueTail(0);	// Written by SD_MixVoices()
 
-globalsoundpos channelSoundPos[MIX_CHANNELS];
+//      Gain of each voice in 8.8 fixed point, left in the upper 16 bits.
+static std::atomic<uint32_t>		voiceGain[SD_MAXVOICES];
+//      Serial of the last sound on each voice that ended by itself.
+static std::atomic<unsigned int>	voiceFinished[SD_MAXVOICES];
+
+//      Audio thread view of the voices
+struct MixVoice
+{
+	const Sint16	*data;
+	unsigned int	length;		// In samples, both channels counted
+	unsigned int	pos;
+	unsigned int	serial;
+	bool			looping;
+	bool			active;
+};
+static MixVoice		mixVoices[SD_MAXVOICES];
+static Sint32		mixBuffer[MIX_BLOCK];
 
 //      Global variables
 bool	AdLibPresent,
@@ -76,7 +175,7 @@ int		SoundVolume=MAX_VOLUME;
 //      Internal variables
 static  bool					SD_Started;
 static  bool					nextsoundpos;
-FString                 SoundPlaying;
+SoundIndex              SoundPlaying;
 static  word                    SoundPriority;
 static  word                    DigiPriority;
 static  int                     LeftPosition;
@@ -87,6 +186,13 @@ static  double                  PlayVolume;
 
 static  bool					DigiPlaying;
 
+//      Sound effect completion. The game thread numbers each AdLib/PC speaker
+//      sound and the audio thread reports the number of the last one to end.
+static  unsigned int			sfxSerial;
+static  bool					sfxActive;
+static  unsigned int			sfxCurrent;		// Audio thread
+static  std::atomic<unsigned int>	sfxFinished(0);
+
 //      PC Sound variables
 static  volatile byte           pcLastSample;
 static  byte * volatile         pcSound;
@@ -107,6 +213,31 @@ static  word                   *sqHackPtr;
 static  int                     sqHackLen;
 static  int                     sqHackSeqLen;
 static  longword                sqHackTime;
+static  unsigned int            sqHackGeneration;	// Audio thread
+//      Game thread view of the sequencer
+static  bool                    sqEnabled;
+static  unsigned int            sqGeneration;
+static  int                     sqStartOffset;
+//      Sequencer generation in the top 8 bits and offset in the rest
+static  std::atomic<unsigned int>	sqPosition(0);
+
+//      IMF music rendered ahead of time (see SDL_GetIMFCache())
+struct IMFCache
+{
+	DWORD					crc;
+	int						length;
+	std::atomic<unsigned int>	generation;	// Sequence a background render is for
+	unsigned int			frames;
+	unsigned int			introFrames;
+	TArray<unsigned int>	eventTicks;	// Music tick each event plays on
+	TArray<Sint16>			pcm;
+	TArray<Sint16>			intro;		// Start of the track as heard when it loops
+	TArray<word>			seq;		// Copy of the sequence for the render thread
+};
+static  IMFCache               *sqCache;			// Audio thread
+static  unsigned int            sqCachePos;
+static  unsigned int            sqCacheEvent;
+static  bool                    sqCacheLooped;
 
 static int musicchunk=-1;
 Mix_Music *music=NULL;
@@ -204,8 +335,16 @@ static Uint64 Mix_GetMusicPCMPosition() { return 0; }
 
 static void SDL_SoundFinished(void)
 {
-	SoundPlaying = FString();
+	SoundPlaying = SoundIndex();
 	SoundPriority = 0;
+	sfxActive = false;
+}
+
+// Returns true while the last AdLib/PC speaker sound started by the game
+// thread hasn't been reported as finished by the audio thread.
+static bool SDL_SfxActive(void)
+{
+	return sfxActive && sfxFinished.load(std::memory_order_acquire) != sfxSerial;
 }
 
 /*
@@ -239,21 +378,12 @@ static longword	pcNumReadySamples = 0;
 // Function prototype is for menu listener
 bool SD_UpdatePCSpeakerVolume(int)
 {
-	SDL_LockMutex(audioMutex);
-
-	if(pcVolume > 0)
-		pcVolume = AdlibVolume*250;
-	else
-		pcVolume = -AdlibVolume*250;
-
-	SDL_UnlockMutex(audioMutex);
-
+	SDL_SendAudioCommand(AC_PCVolume, NULL, AdlibVolume*250);
 	return true;
 }
 
-// Note: The inline functions do not lock or unlock 'audioMutex'. Make sure
-// that the code calling these functions locks/unlocks the mutex before/after
-// calling these functions!
+// Note: The inline functions must only be called from the audio thread (or
+// SDL_ExecAudioCommand()) since they modify the emulator state directly!
 
 inline void _SDL_turnOnPCSpeaker(byte pcSample)
 {
@@ -291,7 +421,7 @@ inline void _SDL_PCService()
 		if(!pcLengthLeft)
 		{
 			pcSound=0;
-			SoundPriority=0;
+			sfxFinished.store(sfxCurrent, std::memory_order_release);
 			_SDL_turnOffPCSpeaker();
 		}
 	}
@@ -309,14 +439,8 @@ _SDL_PCPlaySound(PCSound *sound)
 	if(DigiMode == sds_PC)
 		SD_StopDigitized();
 
-	SDL_LockMutex(audioMutex);
-
-	pcPhaseTick = 0;
-	pcLastSample = 0;	// Must be a value that cannot be played, so the PC Speaker is forced to reset (-1 wraps to 255 so it cannot be used here)
-    pcLengthLeft = LittleLong(sound->common.length);
-    pcSound = sound->data;
-
-	SDL_UnlockMutex(audioMutex);
+	sfxActive = true;
+	SDL_SendAudioCommand(AC_PCPlay, sound, 0, 0, ++sfxSerial);
 }
 
 ///////////////////////////////////////////////////////////////////////////
@@ -327,12 +451,7 @@ _SDL_PCPlaySound(PCSound *sound)
 static void
 _SDL_PCStopSound(void)
 {
-	SDL_LockMutex(audioMutex);
-
-    pcSound = 0;
-	_SDL_turnOffPCSpeaker();
-
-	SDL_UnlockMutex(audioMutex);
+	SDL_SendAudioCommand(AC_PCStop);
 }
 
 ///////////////////////////////////////////////////////////////////////////
@@ -367,8 +486,6 @@ void _SDL_EmulateAndMixPC(Sint16 *buffer, int length)
 
 	if(!pcActive) return; // PC Speaker is turned off
 
-	SDL_LockMutex(audioMutex);
-
 	while(length--)
 	{
 		mix = *buffer;
@@ -396,8 +513,6 @@ void _SDL_EmulateAndMixPC(Sint16 *buffer, int length)
 			pcPhaseTick = 0;
 		}
 	}
-
-	SDL_UnlockMutex(audioMutex);
 }
 
 ///////////////////////////////////////////////////////////////////////////
@@ -412,8 +527,6 @@ void _SDL_PCSpeakerEmulator(void *udata, Uint8 *stream, int len)
     int sampleslen = stereolen>>1;
     Sint16 *stream16 = (Sint16 *) (void *) stream;    // expect correct alignment
 
-	SDL_LockMutex(audioMutex);
-
 	while(1)
     {
         if(pcNumReadySamples)
@@ -443,16 +556,15 @@ void _SDL_PCSpeakerEmulator(void *udata, Uint8 *stream, int len)
 				}
 
 			if(!sampleslen)
-				break;	// We need to unlock the mutex, so we cannot just return!
+				return;
         }
 
+		SDL_DrainAudioCommands();
 		_SDL_PCService();
 
         pcNumReadySamples = pcSamplesPerTick;
 
     }
-
-	SDL_UnlockMutex(audioMutex);
 }
 /*
 =============================================================================
@@ -465,6 +577,265 @@ void _SDL_PCSpeakerEmulator(void *udata, Uint8 *stream, int len)
 #define SDL_PCService()							_SDL_PCService()
 #define SDL_PCEmulateAndMix(buffer, length)		if(SoundMode == sdm_PC) _SDL_EmulateAndMixPC(buffer, length)
 
+/*
+=============================================================================
+============================== Voice mixer ==================================
+=============================================================================
+*/
+
+static void SD_ExecVoiceCommand(const VoiceCommand &cmd)
+{
+	MixVoice &voice = mixVoices[cmd.voice];
+	switch(cmd.type)
+	{
+		case VC_Start:
+			voice.data = cmd.data;
+			voice.length = cmd.length;
+			voice.pos = 0;
+			voice.serial = cmd.serial;
+			voice.looping = cmd.looping;
+			voice.active = cmd.length != 0;
+			if(!voice.active)
+				voiceFinished[cmd.voice].store(cmd.serial, std::memory_order_release);
+			break;
+		case VC_Stop:
+			// The game thread has already forgotten about the sound
+			if(voice.serial == cmd.serial)
+				voice.active = false;
+			break;
+	}
+}
+
+static void SD_AdvanceVoice(int num, unsigned int count)
+{
+	MixVoice &voice = mixVoices[num];
+	if(voice.looping)
+	{
+		voice.pos = (voice.pos + count) % voice.length;
+		return;
+	}
+
+	voice.pos += count;
+	if(voice.pos >= voice.length)
+	{
+		voice.active = false;
+		voiceFinished[num].store(voice.serial, std::memory_order_release);
+	}
+}
+
+// Kept free of branches so that the compiler can vectorize it.
+static void SD_MixSamples(Sint32 *out, const Sint16 *in, unsigned int count, Sint32 left, Sint32 right)
+{
+	for(unsigned int i = 0;i < count;i += 2)
+	{
+		out[i] += (Sint16)LittleShort(in[i])*left;
+		out[i+1] += (Sint16)LittleShort(in[i+1])*right;
+	}
+}
+
+static void SD_MixVoice(int num, uint32_t gain, Sint32 *out, unsigned int count)
+{
+	MixVoice &voice = mixVoices[num];
+	while(count && voice.active)
+	{
+		const unsigned int len = MIN(count, voice.length - voice.pos);
+		SD_MixSamples(out, voice.data + voice.pos, len, gain>>16, gain&0xFFFF);
+		SD_AdvanceVoice(num, len);
+		out += len;
+		count -= len;
+	}
+}
+
+static void SD_ClampMix(Sint16 *stream, const Sint32 *mix, unsigned int count)
+{
+	for(unsigned int i = 0;i < count;++i)
+	{
+		const Sint32 sample = (Sint16)LittleShort(stream[i]) + (mix[i]>>8);
+		stream[i] = LittleShort((Sint16)clamp<Sint32>(sample, -32768, 32767));
+	}
+}
+
+// Registered with Mix_SetPostMix(). Like SDL_IMFMusicPlayer() this expects
+// 16-bit stereo output.
+static void SD_MixVoices(void *udata, Uint8 *stream, int len)
+{
+	const unsigned int head = voiceQueueHead.load(std::memory_order_acquire);
+	unsigned int tail = voiceQueueTail.load(std::memory_order_relaxed);
+	for(;tail != head;++tail)
+		SD_ExecVoiceCommand(voiceQueue[tail & (VOICE_QUEUE_SIZE-1)]);
+	voiceQueueTail.store(tail, std::memory_order_release);
+
+	const unsigned int samples = len>>1;
+
+	// Silent voices are virtual. If too many can be heard only the loudest
+	// are mixed.
+	int audible[SD_MAXVOICES];
+	uint32_t audibleGain[SD_MAXVOICES];
+	unsigned int numAudible = 0;
+	for(int i = 0;i < SD_MAXVOICES;++i)
+	{
+		if(!mixVoices[i].active)
+			continue;
+
+		const uint32_t gain = voiceGain[i].load(std::memory_order_relaxed);
+		if(gain == 0)
+		{
+			SD_AdvanceVoice(i, samples);
+			continue;
+		}
+
+		audibleGain[i] = gain;
+		audible[numAudible++] = i;
+	}
+
+	if(numAudible > SD_MIXVOICES)
+	{
+		std::nth_element(audible, audible + SD_MIXVOICES, audible + numAudible,
+			[&audibleGain](int a, int b) {
+				return (audibleGain[a]>>16) + (audibleGain[a]&0xFFFF) > (audibleGain[b]>>16) + (audibleGain[b]&0xFFFF);
+			});
+		for(unsigned int i = SD_MIXVOICES;i < numAudible;++i)
+			SD_AdvanceVoice(audible[i], samples);
+		numAudible = SD_MIXVOICES;
+	}
+
+	if(numAudible == 0)
+		return;
+
+	Sint16 *stream16 = (Sint16 *) (void *) stream;    // expect correct alignment
+	for(unsigned int block = 0;block < samples;block += MIX_BLOCK)
+	{
+		const unsigned int count = MIN<unsigned int>(MIX_BLOCK, samples - block);
+		memset(mixBuffer, 0, count*sizeof(Sint32));
+		for(unsigned int i = 0;i < numAudible;++i)
+			SD_MixVoice(audible[i], audibleGain[audible[i]], mixBuffer, count);
+		SD_ClampMix(stream16 + block, mixBuffer, count);
+	}
+}
+
+// Does the work of SD_MixVoices() for everything still queued and then cmd on
+// the game thread. The caller must make sure SD_MixVoices() can't run.
+static void SD_ExecVoiceQueue(const VoiceCommand &cmd)
+{
+	const unsigned int head = voiceQueueHead.load(std::memory_order_relaxed);
+	unsigned int tail = voiceQueueTail.load(std::memory_order_relaxed);
+	for(;tail != head;++tail)
+		SD_ExecVoiceCommand(voiceQueue[tail & (VOICE_QUEUE_SIZE-1)]);
+	voiceQueueTail.store(tail, std::memory_order_release);
+
+	SD_ExecVoiceCommand(cmd);
+}
+
+static void SD_SendVoiceCommand(const VoiceCommand &cmd)
+{
+	// Without the post mix hook there is no audio thread to hand it to.
+	if(!voicesHooked)
+	{
+		SD_ExecVoiceQueue(cmd);
+		return;
+	}
+
+	const unsigned int head = voiceQueueHead.load(std::memory_order_relaxed);
+	// The queue only fills up if the audio device is paused or stalled.
+	if(head - voiceQueueTail.load(std::memory_order_acquire) >= VOICE_QUEUE_SIZE)
+	{
+#if SDL_VERSIONNUM(SDL_MIXER_MAJOR_VERSION, SDL_MIXER_MINOR_VERSION, SDL_MIXER_PATCHLEVEL) >= SDL_VERSIONNUM(2,6,0)
+		Mix_LockAudio();
+		SD_ExecVoiceQueue(cmd);
+		Mix_UnlockAudio();
+		return;
+#else
+		// Older SDL_mixer doesn't let us lock out the callback, so give it a
+		// while to catch up and drop the command if it doesn't. A dropped
+		// start is reported as finished so the channel gets freed.
+		const Uint32 start = SDL_GetTicks();
+		do
+		{
+			if(SDL_GetTicks() - start >= VOICE_QUEUE_TIMEOUT)
+			{
+				if(cmd.type == VC_Start)
+					voiceFinished[cmd.voice].store(cmd.serial, std::memory_order_release);
+				return;
+			}
+			SDL_Delay(1);
+		}
+		while(head - voiceQueueTail.load(std::memory_order_acquire) >= VOICE_QUEUE_SIZE);
+#endif
+	}
+
+	voiceQueue[head & (VOICE_QUEUE_SIZE-1)] = cmd;
+	voiceQueueHead.store(head + 1, std::memory_order_release);
+}
+
+static bool SD_VoicePlaying(int num)
+{
+	const SoundVoice &voice = digiVoices[num];
+	return voice.chunk != NULL && voiceFinished[num].load(std::memory_order_acquire) != voice.serial;
+}
+
+static void SD_UpdateVoiceGain(int num)
+{
+	const SoundVoice &voice = digiVoices[num];
+
+	// Same response as Mix_SetPanning(), Mix_SetDistance() and Mix_Volume()
+	// with 256 being unity.
+	const double scale = (256.0/255.0) * ((255 - voice.distance)/255.0) *
+		(MIN(VOLUME_TO_CHAN(voice.volume), 128.0)/128.0);
+	const uint32_t left = (uint32_t)(TO_SDL_POSITION(voice.leftpos)*scale);
+	const uint32_t right = (uint32_t)(TO_SDL_POSITION(voice.rightpos)*scale);
+	voiceGain[num].store((left<<16)|right, std::memory_order_relaxed);
+}
+
+void SD_ChannelFinished(int channel)
+{
+	digiVoices[channel].chunk = NULL;
+
+	SoundPlaying = SoundIndex();
+	channelSoundPos[channel].valid = 0;
+	LoopedAudio::finished (channel);
+}
+
+// Frees voices whose sound has ended. Called from the game thread so that
+// the finish bookkeeping never races with the game.
+void SD_UpdateVoices(void)
+{
+	for(int i = 0;i < SD_MAXVOICES;++i)
+	{
+		if(digiVoices[i].chunk != NULL && !SD_VoicePlaying(i))
+			SD_ChannelFinished(i);
+	}
+}
+
+void SD_HaltChannel(int channel)
+{
+	if(digiVoices[channel].chunk == NULL)
+		return;
+
+	VoiceCommand cmd = { VC_Stop, channel, NULL, 0, false, digiVoices[channel].serial };
+	SD_SendVoiceCommand(cmd);
+	SD_ChannelFinished(channel);
+}
+
+// Returns a free generic voice or steals the oldest one which isn't looping.
+static int SD_AllocVoice()
+{
+	int oldest = -1;
+	for(int i = SD_RESERVEDVOICES;i < SD_MAXVOICES;++i)
+	{
+		const SoundVoice &voice = digiVoices[i];
+		if(voice.chunk == NULL)
+			return i;
+
+		// nobody is allowed to steal from looped audio
+		if(!voice.looping && (oldest == -1 || voice.serial < digiVoices[oldest].serial))
+			oldest = i;
+	}
+
+	if(oldest != -1)
+		SD_HaltChannel(oldest);
+	return oldest;
+}
+
 void SD_StopDigitized(void)
 {
 	DigiPlaying = false;
@@ -473,7 +844,8 @@ void SD_StopDigitized(void)
 	if ((DigiMode == sds_PC) && (SoundMode == sdm_PC))
 		SDL_SoundFinished();
 
-	Mix_HaltChannel(-1);
+	for(int i = 0;i < SD_MAXVOICES;++i)
+		SD_HaltChannel(i);
 }
 
 void SD_SetPosition(int channel, int leftpos, int rightpos, int distance)
@@ -482,16 +854,21 @@ void SD_SetPosition(int channel, int leftpos, int rightpos, int distance)
 			|| ((leftpos == 15) && (rightpos == 15)))
 		Quit("SD_SetPosition: Illegal position");
 
+	SoundVoice &voice = digiVoices[channel];
 	switch (DigiMode)
 	{
 		default:
+			voice.leftpos = voice.rightpos = 0;
+			voice.distance = 0;
 			break;
 		case sds_SoundBlaster:
 //            SDL_PositionSBP(leftpos,rightpos);
-			Mix_SetPanning(channel, TO_SDL_POSITION(leftpos), TO_SDL_POSITION(rightpos));
-			Mix_SetDistance(channel, distance);
+			voice.leftpos = leftpos;
+			voice.rightpos = rightpos;
+			voice.distance = distance;
 			break;
 	}
+	SD_UpdateVoiceGain(channel);
 }
 
 // Mac format sound loading.
@@ -588,12 +965,21 @@ Mix_Chunk* SD_PrepareSound(int which)
 		return NULL;
 
 	FMemLump soundLump = Wads.ReadLump(which);
+	return SD_DecodeSound(soundLump.GetMem(), size);
+}
+
+// Only touches the given data and SDL_mixer, so this is safe to call from
+// worker threads once the audio device is open.
+Mix_Chunk* SD_DecodeSound(const void *data, int size)
+{
+	if(size == 0)
+		return NULL;
 
 	// 0x2A is the size of the sound header. From what I can tell the csnds
 	// have mostly garbage filled headers (outside of what is precisely needed
 	// since the sample rate is hard coded). I'm not sure if the sounds are
 	// 8-bit or 16-bit, but it looks like the sample rate is coded to ~22050.
-	if(BigShort(*(WORD*)soundLump.GetMem()) == 1 && size > 0x2A)
+	if(BigShort(*(const WORD*)data) == 1 && size > 0x2A)
 	{
 		SDL_RWops *ops = SDL_AllocRW();
 		//ops->size = MacSound_Size;
@@ -606,13 +992,13 @@ Mix_Chunk* SD_PrepareSound(int which)
 		((MacSoundData*)ops->hidden.unknown.data1)->data = (uint8_t*)malloc(size-0x2A);
 		((MacSoundData*)ops->hidden.unknown.data1)->size = size-0x2A;
 		((MacSoundData*)ops->hidden.unknown.data1)->pos = 0;
-		memcpy(((MacSoundData*)ops->hidden.unknown.data1)->data, ((char*)soundLump.GetMem())+0x2A, size-0x2A);
+		memcpy(((MacSoundData*)ops->hidden.unknown.data1)->data, ((const char*)data)+0x2A, size-0x2A);
 		for(unsigned int i = size-0x2A;i-- > 0;)
 			((MacSoundData*)ops->hidden.unknown.data1)->data[i] = 0x80+((MacSoundData*)ops->hidden.unknown.data1)->data[i];
 		return Mix_LoadWAV_RW(ops, 1);
 	}
 
-	return Mix_LoadWAV_RW(SDL_RWFromMem(soundLump.GetMem(), size), 1);
+	return Mix_LoadWAV_RW(SDL_RWFromConstMem(data, size), 1);
 }
 
 int SD_PlayDigitized(const SoundData &which,int leftpos,int rightpos,SoundChannel chan,bool looping, int distance, double volume)
@@ -628,55 +1014,42 @@ int SD_PlayDigitized(const SoundData &which,int leftpos,int rightpos,SoundChanne
 
 	SoundInfo.SetLastPlayTick(which, currentTick);
 
-	// just throw looping effects on group 2
-	auto group = looping ? 2 : 1;
+	if(!voicesHooked)
+		return -1;
+
+	SD_UpdateVoices();
 
 	int channel = chan;
 	if(chan == SD_GENERIC)
-	{
-		channel = Mix_GroupAvailable(group);
-		if(channel == -1)
-		{
-			channel = Mix_GroupOldest(group);
-
-			// nobody is allowed to steal from looped audio
-			if (LoopedAudio::claimed (channel))
-				channel = -1;
-		}
-		if(channel == -1)           // All sounds stopped in the meantime?
-			channel = Mix_GroupAvailable(group);
-	}
+		channel = SD_AllocVoice();
+	else
+		SD_HaltChannel(channel);
 	if(channel == -1)
 		return -1;
 
-	SD_SetPosition(channel, leftpos, rightpos, distance);
-
 	DigiPlaying = true;
 
 	Mix_Chunk *sample = which.GetDigitalData();
 	if(sample == NULL)
 		return -1;
 
-	Mix_Volume(channel, static_cast<int> (VOLUME_TO_CHAN(volume)));
-	if(Mix_PlayChannel(channel, sample, looping ? -1 : 0) == -1)
-	{
-		printf("Unable to play sound: %s\n", Mix_GetError());
-		return -1;
-	}
+	SoundVoice &voice = digiVoices[channel];
+	voice.chunk = sample;
+	voice.serial = ++digiSerial;
+	voice.looping = looping;
+	voice.volume = volume;
+	SD_SetPosition(channel, leftpos, rightpos, distance);
+
+	VoiceCommand cmd = { VC_Start, channel, (const Sint16 *) (void *) sample->abuf, (sample->alen>>2)<<1, looping, voice.serial };
+	SD_SendVoiceCommand(cmd);
 
 	return channel;
 }
 
 void SD_SetChannelVolume(int channel, double volume)
 {
-	Mix_Volume(channel, static_cast<int> (VOLUME_TO_CHAN(volume)));
-}
-
-void SD_ChannelFinished(int channel)
-{
-	SoundPlaying = FString();
-	channelSoundPos[channel].valid = 0;
-	LoopedAudio::finished (channel);
+	digiVoices[channel].volume = volume;
+	SD_UpdateVoiceGain(channel);
 }
 
 void
@@ -721,15 +1094,11 @@ SD_SetDigiDevice(SDSMode mode)
 static void
 SDL_ALStopSound(void)
 {
-	SDL_LockMutex(audioMutex);
-
-	alSound = 0;
-	alOut(alFreqH + 0, 0);
-
-	SDL_UnlockMutex(audioMutex);
+	SDL_SendAudioCommand(AC_ALStop);
 }
 
-static void SDL_AlSetChanInst(const Instrument *inst, unsigned int chan)
+template<class Chip>
+static void SDL_AlSetChanInst(Chip &chip, const int &volume, const Instrument *inst, unsigned int chan)
 {
 	static const byte chanOps[OPL_CHANNELS] = {
 		0, 1, 2, 8, 9, 0xA, 0x10, 0x11, 0x12
@@ -738,23 +1107,27 @@ static void SDL_AlSetChanInst(const Instrument *inst, unsigned int chan)
 
 	m = chanOps[chan]; // modulator cell for channel
 	c = m + 3; // carrier cell for channel
-	alOut(m + alChar,inst->mChar);
-	alOut(m + alScale,inst->mScale);
-	alOut(m + alAttack,inst->mAttack);
-	alOut(m + alSus,inst->mSus);
-	alOut(m + alWave,inst->mWave);
-	alOut(c + alChar,inst->cChar);
-	alOut(c + alScale,inst->cScale);
-	alOut(c + alAttack,inst->cAttack);
-	alOut(c + alSus,inst->cSus);
-	alOut(c + alWave,inst->cWave);
+	YM3812Write(chip, m + alChar,inst->mChar, volume);
+	YM3812Write(chip, m + alScale,inst->mScale, volume);
+	YM3812Write(chip, m + alAttack,inst->mAttack, volume);
+	YM3812Write(chip, m + alSus,inst->mSus, volume);
+	YM3812Write(chip, m + alWave,inst->mWave, volume);
+	YM3812Write(chip, c + alChar,inst->cChar, volume);
+	YM3812Write(chip, c + alScale,inst->cScale, volume);
+	YM3812Write(chip, c + alAttack,inst->cAttack, volume);
+	YM3812Write(chip, c + alSus,inst->cSus, volume);
+	YM3812Write(chip, c + alWave,inst->cWave, volume);
 
 	// Note: Switch commenting on these lines for old MUSE compatibility
 //    alOutInIRQ(alFeedCon,inst->nConn);
 
-	alOut(chan + alFreqL,0);
-	alOut(chan + alFreqH,0);
-	alOut(chan + alFeedCon,0);
+	YM3812Write(chip, chan + alFreqL,0, volume);
+	YM3812Write(chip, chan + alFreqH,0, volume);
+	YM3812Write(chip, chan + alFeedCon,0, volume);
+}
+static void SDL_AlSetChanInst(const Instrument *inst, unsigned int chan)
+{
+	SDL_AlSetChanInst(oplChip, AdlibVolume, inst, chan);
 }
 static void SDL_AlSetFXInst(const Instrument *inst)
 {
@@ -769,27 +1142,13 @@ static void SDL_AlSetFXInst(const Instrument *inst)
 static void
 SDL_ALPlaySound(AdLibSound *sound)
 {
-	Instrument      *inst;
-	byte            *data;
-
-	SDL_ALStopSound();
-
-	SDL_LockMutex(audioMutex);
-
-	alLengthLeft = LittleLong(sound->common.length);
-	data = sound->data;
-	alBlock = ((sound->block & 7) << 2) | 0x20;
-	inst = &sound->inst;
-
-	if (!(inst->mSus | inst->cSus))
+	if (!(sound->inst.mSus | sound->inst.cSus))
 	{
 		Quit("SDL_ALPlaySound() - Bad instrument");
 	}
 
-	SDL_AlSetFXInst(inst);
-	alSound = (byte *)data;
-
-	SDL_UnlockMutex(audioMutex);
+	sfxActive = true;
+	SDL_SendAudioCommand(AC_ALPlay, sound, 0, 0, ++sfxSerial);
 }
 
 ///////////////////////////////////////////////////////////////////////////
@@ -800,14 +1159,7 @@ SDL_ALPlaySound(AdLibSound *sound)
 static void
 SDL_ShutAL(void)
 {
-	SDL_LockMutex(audioMutex);
-
-	alSound = 0;
-	//alOut(alEffects,0);	// Sound effects should not mess with the music's rhythm settings!
-	alOut(alFreqH + 0,0);
-	SDL_AlSetFXInst(&alZeroInst);
-
-	SDL_UnlockMutex(audioMutex);
+	SDL_SendAudioCommand(AC_ALShut);
 }
 
 ///////////////////////////////////////////////////////////////////////////
@@ -818,8 +1170,7 @@ SDL_ShutAL(void)
 static void
 SDL_StartAL(void)
 {
-	//alOut(alEffects, 0);	// Sound effects should not mess with the music's rhythm settings!
-	SDL_AlSetFXInst(&alZeroInst);
+	SDL_SendAudioCommand(AC_ALStart);
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -860,7 +1211,7 @@ SDL_StartDevice(void)
 			SDL_StartAL();
 			break;
 	}
-	SoundPlaying = FString();
+	SoundPlaying = SoundIndex();
 	SoundPriority = 0;
 }
 
@@ -937,6 +1288,225 @@ bool SD_SetMusicMode(SMMode mode)
 	return(result);
 }
 
+///////////////////////////////////////////////////////////////////////////
+//
+//      SDL_ExecAudioCommand() - Applies a command from the game thread to the
+//              emulated sound hardware
+//
+///////////////////////////////////////////////////////////////////////////
+static const Instrument ChannelRelease = {
+	0, 0,
+	0x3F, 0x3F,
+	0xFF, 0xFF,
+	0xF, 0xF,
+	0, 0,
+	0,
+
+	0, 0, {0, 0, 0}
+};
+
+static void SDL_SeekIMFCache(int offset);
+static void SDL_ShutIMFCache();
+
+static void SDL_ExecAudioCommand(const AudioCommand &cmd)
+{
+	switch(cmd.type)
+	{
+		case AC_PCPlay:
+		{
+			PCSound *sound = (PCSound *)cmd.data;
+			pcPhaseTick = 0;
+			pcLastSample = 0;	// Must be a value that cannot be played, so the PC Speaker is forced to reset (-1 wraps to 255 so it cannot be used here)
+			pcLengthLeft = LittleLong(sound->common.length);
+			pcSound = sound->data;
+			sfxCurrent = cmd.serial;
+			break;
+		}
+		case AC_PCStop:
+			pcSound = 0;
+			_SDL_turnOffPCSpeaker();
+			break;
+		case AC_PCVolume:
+			pcVolume = pcVolume > 0 ? cmd.arg1 : -cmd.arg1;
+			break;
+		case AC_ALPlay:
+		{
+			AdLibSound *sound = (AdLibSound *)cmd.data;
+			alSound = 0;
+			alOut(alFreqH + 0, 0);
+
+			alLengthLeft = LittleLong(sound->common.length);
+			alBlock = ((sound->block & 7) << 2) | 0x20;
+			SDL_AlSetFXInst(&sound->inst);
+			alSound = sound->data;
+			sfxCurrent = cmd.serial;
+			break;
+		}
+		case AC_ALStop:
+			alSound = 0;
+			alOut(alFreqH + 0, 0);
+			break;
+		case AC_ALStart:
+			//alOut(alEffects, 0);	// Sound effects should not mess with the music's rhythm settings!
+			SDL_AlSetFXInst(&alZeroInst);
+			break;
+		case AC_ALShut:
+			alSound = 0;
+			//alOut(alEffects,0);	// Sound effects should not mess with the music's rhythm settings!
+			alOut(alFreqH + 0,0);
+			SDL_AlSetFXInst(&alZeroInst);
+			break;
+		case AC_MusicCache:
+			sqCache = (IMFCache *)cmd.data;
+			break;
+		case AC_MusicStart:
+			sqHack = sqHackPtr = (word *)cmd.data;
+			sqHackLen = sqHackSeqLen = cmd.arg1;
+			sqHackGeneration = cmd.serial;
+			if(sqCache)
+				SDL_SeekIMFCache(cmd.arg2);
+			else if(cmd.arg2 == 0)
+			{
+				for (int i = 0;i < OPL_CHANNELS;++i)
+					SDL_AlSetChanInst(&ChannelRelease, i);
+			}
+			else
+			{
+				// fast forward to correct position
+				// (needed to reconstruct the instruments)
+				for(int i = 0; i < cmd.arg2; i += 2)
+				{
+					byte reg = *(byte *)sqHackPtr;
+					byte val = *(((byte *)sqHackPtr) + 1);
+					if(reg >= 0xb1 && reg <= 0xb8) val &= 0xdf;           // disable play note flag
+					else if(reg == 0xbd) val &= 0xe0;                     // disable drum flags
+
+					alOut(reg,val);
+					sqHackPtr += 2;
+					sqHackLen -= 4;
+				}
+			}
+			sqHackTime = 0;
+			alTimeCount = 0;
+			break;
+		case AC_MusicOn:
+			sqActive = true;
+			break;
+		case AC_MusicOff:
+			sqActive = false;
+			if(cmd.arg1)
+			{
+				alOut(alEffects, 0);
+				for (int i = 0;i < sqMaxTracks;i++)
+					alOut(alFreqH + i + 1, 0);
+			}
+			break;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////
+//
+//      SDL_SendAudioCommand() - Queues a command for the audio thread. If the
+//              AdLib emulator isn't hooked the command is run immediately.
+//
+///////////////////////////////////////////////////////////////////////////
+static void SDL_SendAudioCommand(EAudioCommand type, void *data, int arg1, int arg2, unsigned int serial)
+{
+	AudioCommand cmd = { type, data, arg1, arg2, serial };
+
+	if(!imfHooked)
+	{
+		SDL_ExecAudioCommand(cmd);
+		return;
+	}
+
+	const unsigned int head = audioQueueHead.load(std::memory_order_relaxed);
+	// The queue should never fill up unless the audio thread stalls.
+	if(head - audioQueueTail.load(std::memory_order_acquire) >= AUDIO_QUEUE_SIZE)
+	{
+#if SDL_VERSIONNUM(SDL_MIXER_MAJOR_VERSION, SDL_MIXER_MINOR_VERSION, SDL_MIXER_PATCHLEVEL) >= SDL_VERSIONNUM(2,6,0)
+		Mix_LockAudio();
+		SDL_DrainAudioCommands();
+		SDL_ExecAudioCommand(cmd);
+		Mix_UnlockAudio();
+		return;
+#else
+		// Same as SD_SendVoiceCommand(), a dropped sound is reported as
+		// finished so nothing waits on it.
+		const Uint32 start = SDL_GetTicks();
+		do
+		{
+			if(SDL_GetTicks() - start >= AUDIO_QUEUE_TIMEOUT)
+			{
+				if(type == AC_PCPlay || type == AC_ALPlay)
+					sfxFinished.store(serial, std::memory_order_release);
+				printf("Audio thread stalled, dropped command %d\n", type);
+				return;
+			}
+			SDL_Delay(1);
+		}
+		while(head - audioQueueTail.load(std::memory_order_acquire) >= AUDIO_QUEUE_SIZE);
+#endif
+	}
+
+	audioQueue[head & (AUDIO_QUEUE_SIZE-1)] = cmd;
+	audioQueueHead.store(head + 1, std::memory_order_release);
+}
+
+///////////////////////////////////////////////////////////////////////////
+//
+//      SDL_DrainAudioCommands() - Runs all pending commands. Called by the
+//              audio thread at the start of every service tick.
+//
+///////////////////////////////////////////////////////////////////////////
+static void SDL_DrainAudioCommands()
+{
+	const unsigned int head = audioQueueHead.load(std::memory_order_acquire);
+	unsigned int tail = audioQueueTail.load(std::memory_order_relaxed);
+
+	if(tail == head)
+		return;
+
+	for(;tail != head;++tail)
+		SDL_ExecAudioCommand(audioQueue[tail & (AUDIO_QUEUE_SIZE-1)]);
+	audioQueueTail.store(tail, std::memory_order_release);
+}
+
+///////////////////////////////////////////////////////////////////////////
+//
+//      SDL_FlushAudioCommands() - Makes sure the audio thread has processed
+//              everything queued so far. Needed before freeing memory that
+//              the audio thread may still be reading. Returns false if the
+//              audio thread didn't get to it in time.
+//
+///////////////////////////////////////////////////////////////////////////
+static bool SDL_FlushAudioCommands()
+{
+	if(!imfHooked || audioQueueTail.load(std::memory_order_acquire) == audioQueueHead.load(std::memory_order_relaxed))
+		return true;
+
+#if SDL_VERSIONNUM(SDL_MIXER_MAJOR_VERSION, SDL_MIXER_MINOR_VERSION, SDL_MIXER_PATCHLEVEL) >= SDL_VERSIONNUM(2,6,0)
+	// Rather than waiting for the next callback, run them here.
+	Mix_LockAudio();
+	SDL_DrainAudioCommands();
+	Mix_UnlockAudio();
+	return true;
+#else
+	const Uint32 start = SDL_GetTicks();
+	do
+	{
+		if(SDL_GetTicks() - start >= AUDIO_QUEUE_TIMEOUT)
+		{
+			printf("Audio thread stalled, not waiting for it any longer\n");
+			return false;
+		}
+		SDL_Delay(1);
+	}
+	while(audioQueueTail.load(std::memory_order_acquire) != audioQueueHead.load(std::memory_order_relaxed));
+	return true;
+#endif
+}
+
 int numreadysamples = 0;
 int soundTimeCounter = SOUND_TICKS;
 int samplesPerMusicTick;
@@ -955,8 +1525,9 @@ If you really WANT to set the behavior so that an AdLib sound will not be re-
 started when it is interrupted by itself, you should change the code in the
 SDL_AlPlaySound() function instead, making sure not to reset the instrument.
 
-Any thread-safety issues should be solved now. The mutex 'audioMutex' protects
-gloabal variables that need to be accessed in SDL_IMFMusicPlayer().
+Any thread-safety issues should be solved now. The global variables that need
+to be accessed in SDL_IMFMusicPlayer() are only modified through the audio
+command queue (see SDL_SendAudioCommand()).
 
 -- K1n9_Duk3
 -----------------------------------------------------------------------------*/
@@ -964,6 +1535,83 @@ gloabal variables that need to be accessed in SDL_IMFMusicPlayer().
 //byte *curAlSoundPtr = 0;
 //longword curAlLengthLeft = 0;
 
+///////////////////////////////////////////////////////////////////////////
+//
+//      Playback of pre-rendered IMF music. The position advances one music
+//              tick at a time like the live sequencer so that SD_MusicOff()
+//              still gets a sequence offset.
+//
+///////////////////////////////////////////////////////////////////////////
+static void SDL_SeekIMFCache(int offset)
+{
+	const unsigned int event = offset/2;
+	if(event < sqCache->eventTicks.Size())
+	{
+		sqCachePos = sqCache->eventTicks[event]*samplesPerMusicTick;
+		sqCacheEvent = event;
+	}
+	else
+		sqCachePos = sqCacheEvent = 0;
+	sqCacheLooped = false;
+}
+
+static void SDL_IMFCacheTick()
+{
+	if(sqCachePos >= sqCache->frames)
+	{
+		sqCachePos = 0;
+		sqCacheEvent = 0;
+		sqCacheLooped = true;
+	}
+
+	const unsigned int tick = sqCachePos/samplesPerMusicTick;
+	const unsigned int numEvents = sqCache->eventTicks.Size();
+	while(sqCacheEvent < numEvents && sqCache->eventTicks[sqCacheEvent] <= tick)
+		++sqCacheEvent;
+
+	// The live sequencer is back at the start once the last event played
+	const unsigned int offset = sqCacheEvent < numEvents ? sqCacheEvent*2 : 0;
+	sqPosition.store(((sqHackGeneration&0xFF)<<24)|(offset&0xFFFFFF), std::memory_order_release);
+}
+
+// Never crosses a tick boundary, so the source doesn't change part way.
+static void SDL_IMFCacheMix(Sint16 *stream, int length)
+{
+	const Sint16 *src = sqCacheLooped && sqCachePos < sqCache->introFrames ?
+		&sqCache->intro[sqCachePos*2] : &sqCache->pcm[sqCachePos*2];
+	const Sint32 gain = (Sint32)(MULTIPLY_VOLUME(MusicVolume)*256);
+
+	for(int i = 0;i < length*2;++i)
+	{
+		const Sint32 sample = (Sint16)LittleShort(stream[i]) + (((Sint16)LittleShort(src[i])*gain)>>8);
+		stream[i] = LittleShort((Sint16)clamp<Sint32>(sample, -32768, 32767));
+	}
+	sqCachePos += length;
+}
+
+#ifdef USE_GPL
+static std::atomic<IMFCache *>		imfRendered(NULL);
+
+// Switches to a track finished by the render thread when the live sequence
+// loops around.
+static void SDL_AdoptIMFCache()
+{
+	IMFCache *cache = imfRendered.load(std::memory_order_acquire);
+	if(cache == NULL || cache->generation.load(std::memory_order_relaxed) != sqHackGeneration)
+		return;
+
+	alOut(alEffects, 0);
+	for (int i = 0;i < sqMaxTracks;i++)
+		alOut(alFreqH + i + 1, 0);
+
+	sqCache = cache;
+	sqCachePos = sqCacheEvent = 0;
+	sqCacheLooped = true;
+}
+#else
+#define SDL_AdoptIMFCache()
+#endif
+
 void SDL_IMFMusicPlayer(void *udata, Uint8 *stream, int len)
 {
 	int stereolen = len>>1;
@@ -976,9 +1624,12 @@ void SDL_IMFMusicPlayer(void *udata, Uint8 *stream, int len)
 		{
 			if(numreadysamples<sampleslen)
 			{
-				if(MusicMode == smm_AdLib || SoundMode == sdm_AdLib)
+				if((MusicMode == smm_AdLib && !sqCache) || SoundMode == sdm_AdLib)
 					YM3812UpdateOne(oplChip, stream16, numreadysamples);
 
+				if(sqActive && sqCache)
+					SDL_IMFCacheMix(stream16, numreadysamples);
+
 				// Mix the emulated PC sounds into the AdLib buffer:
 				SDL_PCEmulateAndMix(stream16, numreadysamples);
 
@@ -987,9 +1638,12 @@ void SDL_IMFMusicPlayer(void *udata, Uint8 *stream, int len)
 			}
 			else
 			{
-				if(MusicMode == smm_AdLib || SoundMode == sdm_AdLib)
+				if((MusicMode == smm_AdLib && !sqCache) || SoundMode == sdm_AdLib)
 					YM3812UpdateOne(oplChip, stream16, sampleslen);
 
+				if(sqActive && sqCache)
+					SDL_IMFCacheMix(stream16, sampleslen);
+
 				// Mix the emulated PC sounds into the AdLib buffer:
 				SDL_PCEmulateAndMix(stream16, sampleslen);
 
@@ -998,7 +1652,7 @@ void SDL_IMFMusicPlayer(void *udata, Uint8 *stream, int len)
 			}
 		}
 
-		SDL_LockMutex(audioMutex);
+		SDL_DrainAudioCommands();
 
 		soundTimeCounter--;
 		if(!soundTimeCounter)
@@ -1020,12 +1674,14 @@ void SDL_IMFMusicPlayer(void *udata, Uint8 *stream, int len)
 				if (!(--alLengthLeft))
 				{
 					alSound = 0;
-					SoundPriority=0;
+					sfxFinished.store(sfxCurrent, std::memory_order_release);
 					alOut(alFreqH, 0);
 				}
 			}
 		}
-		if(sqActive)
+		if(sqActive && sqCache)
+			SDL_IMFCacheTick();
+		else if(sqActive)
 		{
 			do
 			{
@@ -1043,14 +1699,30 @@ void SDL_IMFMusicPlayer(void *udata, Uint8 *stream, int len)
 				sqHackLen = sqHackSeqLen;
 				sqHackTime = 0;
 				alTimeCount = 0;
+				SDL_AdoptIMFCache();
 			}
+			sqPosition.store(((sqHackGeneration&0xFF)<<24)|((sqHackPtr-sqHack)&0xFFFFFF), std::memory_order_release);
 		}
 		numreadysamples = samplesPerMusicTick;
-
-		SDL_UnlockMutex(audioMutex);
 	}
 }
 
+///////////////////////////////////////////////////////////////////////////
+//
+//      SDL_HookIMFPlayer() - Installs or removes the AdLib emulator as the
+//              music hook
+//
+///////////////////////////////////////////////////////////////////////////
+static void SDL_HookIMFPlayer(bool hook)
+{
+	Mix_HookMusic(hook ? SDL_IMFMusicPlayer : NULL, 0);
+	imfHooked = hook;
+
+	// The callback can no longer run, so take over the pending commands
+	if(!hook)
+		SDL_DrainAudioCommands();
+}
+
 ///////////////////////////////////////////////////////////////////////////
 //
 //      SD_Startup() - starts up the Sound Mgr
@@ -1071,12 +1743,6 @@ SD_Startup(void)
 		return;
 	}
 
-	if((audioMutex = SDL_CreateMutex()) == NULL)
-	{
-		printf("Unable to create audio mutex\n");
-		return;
-	}
-
 #if defined(__ANDROID__)
 	// Working directory will be in the form: Beloko/Wolf3d/FULL
 	Mix_SetSoundFonts("../../FluidR3_GM.sf2");
@@ -1091,12 +1757,11 @@ SD_Startup(void)
 	}
 	atterm(Mix_CloseAudio);
 
-	// reserve player, boss weapon and adlib channels
-	Mix_ReserveChannels(3);
-	// reserve 2 channels under group 2
-	Mix_GroupChannels(3, 4, 2);
-	// group remaining channels under group 1
-	Mix_GroupChannels(5, MIX_CHANNELS-1, 1);
+	// Digitized sounds are mixed by SD_MixVoices() instead of on SDL_mixer
+	// channels.
+	Mix_AllocateChannels(0);
+	Mix_SetPostMix(SD_MixVoices, NULL);
+	voicesHooked = true;
 
 	// Init music
 	if(YM3812Init(1,3579545,param_samplerate))
@@ -1111,8 +1776,7 @@ SD_Startup(void)
 //    YM3812Write(0,8,0); // Set CSM=0 & SEL=0		 // already set in for statement
 
 	samplesPerMusicTick = param_samplerate / MUSIC_RATE;    // SDL_t0FastAsmService played at 700Hz
-	Mix_HookMusic(SDL_IMFMusicPlayer, 0);
-	Mix_ChannelFinished(SD_ChannelFinished);
+	SDL_HookIMFPlayer(true);
 
 	Mix_VolumeMusic(static_cast<int> (ceil(128.0*MULTIPLY_VOLUME(MusicVolume))));
 
@@ -1147,12 +1811,10 @@ SD_Shutdown(void)
 
 	SD_MusicOff();
 	SD_StopSound();
-
-	if(audioMutex != NULL)
-	{
-		SDL_DestroyMutex(audioMutex);
-		audioMutex = NULL;
-	}
+	SDL_HookIMFPlayer(false);
+	Mix_SetPostMix(NULL, NULL);
+	voicesHooked = false;
+	SDL_ShutIMFCache();
 
 	SDL_QuitSubSystem(SDL_INIT_AUDIO);
 
@@ -1204,7 +1866,7 @@ SD_SetPlayVolume(double volume)
 //              Returns the channel of the sound if it played, else -1.
 //
 ///////////////////////////////////////////////////////////////////////////
-int SD_PlaySound(const char* sound, SoundChannel chan)
+int SD_PlaySound(const SoundIndex &sound, SoundChannel chan)
 {
 	bool            ispos;
 	int             lp,rp,dist;
@@ -1270,7 +1932,7 @@ int SD_PlaySound(const char* sound, SoundChannel chan)
 
 //    if (!s->length)
 //        Quit("SD_PlaySound() - Zero length sound");
-	if (sindex.GetPriority() < SoundPriority)
+	if (SDL_SfxActive() && sindex.GetPriority() < SoundPriority)
 		return -1;
 
 #ifndef ECWOLF_MIXER
@@ -1326,22 +1988,20 @@ bool SD_SoundPlaying(void)
 		default:
 			break;
 		case sdm_PC:
-			result = pcSound? true : false;	// not really thread-safe, but a mutex would be overkill
-			break;
 		case sdm_AdLib:
-			result = alSound? true : false;	// not really thread-safe, but a mutex would be overkill
+			result = SDL_SfxActive();
 			break;
 	}
 
 	if (result)
-		return SoundPlaying.IsNotEmpty();
+		return SoundPlaying != 0;
 	else
 		return false;
 }
 
 bool SD_ChannelPlaying(SoundChannel chan)
 {
-	return Mix_Playing(chan) > 0;
+	return SD_VoicePlaying(chan);
 }
 
 ///////////////////////////////////////////////////////////////////////////
@@ -1392,7 +2052,8 @@ SD_WaitSoundDone(void)
 void
 SD_MusicOn(void)
 {
-	sqActive = true;	// not really thread-safe, but a mutex would be overkill
+	sqEnabled = true;
+	SDL_SendAudioCommand(AC_MusicOn);
 }
 
 ///////////////////////////////////////////////////////////////////////////
@@ -1404,28 +2065,24 @@ SD_MusicOn(void)
 int
 SD_MusicOff(void)
 {
-	word    i;
 	int musoffs;
 
-	SDL_LockMutex(audioMutex);
-
-	sqActive = false;
-	musoffs = (int) (sqHackPtr-sqHack);
+	// The audio thread may not have reached the current sequence yet
+	const unsigned int pos = sqPosition.load(std::memory_order_acquire);
+	if((pos>>24) == (sqGeneration&0xFF))
+		musoffs = (int) (pos&0xFFFFFF);
+	else
+		musoffs = sqStartOffset;
 
-	SDL_UnlockMutex(audioMutex);
+	sqEnabled = false;
+	SDL_SendAudioCommand(AC_MusicOff, NULL, MusicMode == smm_AdLib && music == NULL);
 
 	switch (MusicMode)
 	{
 		default:
 			break;
 		case smm_AdLib:
-			if (music == NULL)
-			{
-				alOut(alEffects, 0);
-				for (i = 0;i < sqMaxTracks;i++)
-					alOut(alFreqH + i + 1, 0);
-			}
-			else
+			if (music != NULL)
 			{
 				if(Mix_PlayingMusic() == 1)
 				{
@@ -1442,23 +2099,315 @@ SD_MusicOff(void)
 
 ///////////////////////////////////////////////////////////////////////////
 //
-//      SD_StartMusic() - starts playing the music pointed to
+//      IMF music cache. With snd_imfcache set each track is rendered once on
+//              a background thread with its own OPL chip and played back from
+//              memory afterwards, leaving the live chip to the sound effects.
+//              The first time a track plays it is synthesized live until it
+//              loops. Rendered tracks can also be kept in the cache directory.
 //
 ///////////////////////////////////////////////////////////////////////////
-void
-SD_StartMusic(const char* chunk)
+#ifdef USE_GPL
+
+#define IMF_CACHE_TRACKS	2	// Kept in memory, each is ~10MB/minute
+#define IMF_CACHE_ID		MAKE_ID('I','M','F','C')
+#define IMF_CACHE_VERSION	1
+
+struct IMFCacheHeader
+{
+	DWORD	id;
+	DWORD	version;
+	DWORD	rate;
+	DWORD	frames;
+	DWORD	introFrames;
+	DWORD	events;
+};
+
+static TArray<IMFCache *>	imfCaches;		// Least recently used first
+static IMFCache				*imfInUse;		// Track the audio thread may be playing from
+static IMFCache				*imfRendering;
+static std::thread			imfRenderThread;
+static std::atomic<bool>	imfRenderCancel(false);
+static std::atomic<bool>	imfRenderDone(false);
+
+static FString SDL_IMFCachePath(const IMFCache *cache)
+{
+	FString path;
+	path.Format("%s" PATH_SEPARATOR "imf%08X%08X_%d.pcm",
+		FileSys::GetDirectoryPath(FileSys::DIR_Cache).GetChars(),
+		cache->crc, cache->length, param_samplerate);
+	return path;
+}
+
+static bool SDL_LoadIMFCache(IMFCache *cache)
+{
+	FILE *file = File(SDL_IMFCachePath(cache)).open("rb");
+	if(!file)
+		return false;
+
+	IMFCacheHeader header;
+	bool valid = fread(&header, sizeof(header), 1, file) == 1 &&
+		header.id == IMF_CACHE_ID && header.version == IMF_CACHE_VERSION &&
+		header.rate == (DWORD)param_samplerate && header.events != 0 &&
+		header.frames != 0 && header.frames % samplesPerMusicTick == 0 &&
+		header.introFrames != 0 && header.introFrames <= header.frames &&
+		header.introFrames % samplesPerMusicTick == 0;
+	if(valid)
+	{
+		cache->frames = header.frames;
+		cache->introFrames = header.introFrames;
+		cache->eventTicks.Resize(header.events);
+		cache->pcm.Resize(header.frames*2);
+		cache->intro.Resize(header.introFrames*2);
+		valid = fread(&cache->eventTicks[0], sizeof(unsigned int), header.events, file) == header.events &&
+			fread(&cache->pcm[0], sizeof(Sint16), header.frames*2, file) == header.frames*2 &&
+			fread(&cache->intro[0], sizeof(Sint16), header.introFrames*2, file) == header.introFrames*2;
+	}
+	fclose(file);
+	return valid;
+}
+
+static void SDL_SaveIMFCache(const IMFCache *cache)
 {
-	static const Instrument ChannelRelease = {
-		0, 0,
-		0x3F, 0x3F,
-		0xFF, 0xFF,
-		0xF, 0xF,
-		0, 0,
-		0,
+	FILE *file = File(SDL_IMFCachePath(cache)).open("wb");
+	if(!file)
+		return;
 
-		0, 0, {0, 0, 0}
+	IMFCacheHeader header = {
+		IMF_CACHE_ID, IMF_CACHE_VERSION, (DWORD)param_samplerate,
+		cache->frames, cache->introFrames, cache->eventTicks.Size()
 	};
+	fwrite(&header, sizeof(header), 1, file);
+	fwrite(&cache->eventTicks[0], sizeof(unsigned int), cache->eventTicks.Size(), file);
+	fwrite(&cache->pcm[0], sizeof(Sint16), cache->pcm.Size(), file);
+	fwrite(&cache->intro[0], sizeof(Sint16), cache->intro.Size(), file);
+	fclose(file);
+}
+
+// Follows the timing of SDL_IMFMusicPlayer() exactly: events are played at the
+// start of each 700 Hz tick and the sequence restarts the tick after its last
+// event. The second pass renders the start of the track again with the chip
+// state left over from the end, which is what is heard when it loops.
+static bool SDL_RenderIMF(IMFCache *cache)
+{
+	static const int volume = MAX_VOLUME;
+	const word *seq = &cache->seq[0];
+	const unsigned int spt = samplesPerMusicTick;
+
+	unsigned int ticks = 0;
+	{
+		const word *ptr = seq;
+		int left = cache->length;
+		longword time = 0;
+		for(;left > 0;++ticks)
+		{
+			while(left > 0 && time <= ticks)
+			{
+				time = ticks + LittleShort(ptr[1]);
+				ptr += 2;
+				left -= 4;
+			}
+		}
+	}
+
+	cache->frames = ticks*spt;
+	cache->introFrames = MIN<unsigned int>(ticks, MUSIC_RATE)*spt;
+	cache->pcm.Resize(cache->frames*2);
+	cache->intro.Resize(cache->introFrames*2);
+	cache->eventTicks.Clear();
+
+	DBOPL::Chip chip;
+	chip.Setup(param_samplerate);
+	for(int i = 1;i < 0xf6;++i)
+		YM3812Write(chip, i, 0, volume);
+	YM3812Write(chip, 1, 0x20, volume);
+	for(int i = 0;i < OPL_CHANNELS;++i)
+		SDL_AlSetChanInst(chip, volume, &ChannelRelease, i);
+
+	for(int pass = 0;pass < 2;++pass)
+	{
+		Sint16 *out = pass == 0 ? &cache->pcm[0] : &cache->intro[0];
+		const unsigned int passTicks = (pass == 0 ? cache->frames : cache->introFrames)/spt;
+		const word *ptr = seq;
+		int left = cache->length;
+		longword time = 0;
+		for(unsigned int tick = 0;tick < passTicks;++tick)
+		{
+			if(imfRenderCancel.load(std::memory_order_relaxed))
+				return false;
+
+			while(left > 0 && time <= tick)
+			{
+				time = tick + LittleShort(ptr[1]);
+				YM3812Write(chip, *(const byte *) ptr, *(((const byte *) ptr)+1), volume);
+				if(pass == 0)
+					cache->eventTicks.Push(tick);
+				ptr += 2;
+				left -= 4;
+			}
+
+			YM3812UpdateOne(chip, out, spt);
+			out += spt*2;
+		}
+	}
+	return true;
+}
+
+static void SDL_IMFRenderThread(IMFCache *cache, bool toDisk)
+{
+	if(SDL_RenderIMF(cache))
+	{
+		imfRendered.store(cache, std::memory_order_release);
+		if(toDisk)
+			SDL_SaveIMFCache(cache);
+	}
+	else
+		cache->frames = 0;
+	imfRenderDone.store(true, std::memory_order_release);
+}
+
+// Frees a track, taking it away from the audio thread first if needed. If
+// the audio thread is stuck the track is leaked rather than freed under it.
+static void SDL_FreeIMFCache(IMFCache *cache)
+{
+	if(cache == imfInUse)
+	{
+		SDL_SendAudioCommand(AC_MusicCache, NULL);
+		imfInUse = NULL;
+		if(!SDL_FlushAudioCommands())
+			return;
+	}
+	delete cache;
+}
+
+static void SDL_AddIMFCache(IMFCache *cache)
+{
+	imfCaches.Push(cache);
+	while(imfCaches.Size() > IMF_CACHE_TRACKS)
+	{
+		SDL_FreeIMFCache(imfCaches[0]);
+		imfCaches.Delete(0);
+	}
+}
+
+static void SDL_FinishIMFRender(bool cancel)
+{
+	if(imfRendering == NULL)
+		return;
+
+	if(cancel)
+		imfRenderCancel.store(true, std::memory_order_relaxed);
+	imfRenderThread.join();
+	imfRenderCancel.store(false, std::memory_order_relaxed);
+	imfRendered.store(NULL, std::memory_order_relaxed);
+
+	IMFCache *cache = imfRendering;
+	imfRendering = NULL;
+	cache->seq.Clear();
+	cache->seq.ShrinkToFit();
+	if(cache->frames == 0)
+		delete cache;
+	else
+	{
+		// SDL_AdoptIMFCache() may have switched to it.
+		if(cache->generation.load(std::memory_order_relaxed) == sqGeneration)
+			imfInUse = cache;
+		SDL_AddIMFCache(cache);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////
+//
+//      SDL_GetIMFCache() - Returns the rendered track for a sequence, or NULL
+//              if it has to be synthesized live for now
+//
+///////////////////////////////////////////////////////////////////////////
+static IMFCache *SDL_GetIMFCache(const word *seq, int len)
+{
+	if(snd_imfcache == 0 || len < 4 || (len & 3))
+		return NULL;
+
+	// Make sure the audio thread has taken the track last handed to it, so
+	// imfInUse is the only one it can be reading.
+	SDL_FlushAudioCommands();
 
+	if(imfRendering && imfRenderDone.load(std::memory_order_acquire))
+		SDL_FinishIMFRender(false);
+
+	const DWORD crc = CalcCRC32((const BYTE *)seq, len);
+	for(unsigned int i = 0;i < imfCaches.Size();++i)
+	{
+		IMFCache *cache = imfCaches[i];
+		if(cache->crc == crc && cache->length == len)
+		{
+			imfCaches.Delete(i);
+			imfCaches.Push(cache);
+			imfInUse = cache;
+			return cache;
+		}
+	}
+
+	if(imfRendering && imfRendering->crc == crc && imfRendering->length == len)
+	{
+		imfRendering->generation.store(sqGeneration, std::memory_order_relaxed);
+		return NULL;
+	}
+
+	IMFCache *cache = new IMFCache;
+	cache->crc = crc;
+	cache->length = len;
+	cache->generation.store(sqGeneration, std::memory_order_relaxed);
+	if(snd_imfcache >= 2 && SDL_LoadIMFCache(cache))
+	{
+		SDL_AddIMFCache(cache);
+		imfInUse = cache;
+		return cache;
+	}
+
+	SDL_FinishIMFRender(true);
+	cache->seq.Resize(len/2);
+	memcpy(&cache->seq[0], seq, len);
+	imfRendering = cache;
+	imfRenderDone.store(false, std::memory_order_relaxed);
+	imfRenderThread = std::thread(SDL_IMFRenderThread, cache, snd_imfcache >= 2);
+	return NULL;
+}
+
+static void SDL_ShutIMFCache()
+{
+	SDL_FinishIMFRender(true);
+	for(unsigned int i = 0;i < imfCaches.Size();++i)
+		SDL_FreeIMFCache(imfCaches[i]);
+	imfCaches.Clear();
+}
+
+#else
+
+static IMFCache *SDL_GetIMFCache(const word *seq, int len) { return NULL; }
+static void SDL_ShutIMFCache() {}
+
+#endif
+
+///////////////////////////////////////////////////////////////////////////
+//
+//      SDL_StartSequence() - hands a new IMF sequence to the audio thread
+//
+///////////////////////////////////////////////////////////////////////////
+static void SDL_StartSequence(word *seq, int len, int startoffs)
+{
+	sqStartOffset = startoffs;
+	++sqGeneration;
+	SDL_SendAudioCommand(AC_MusicCache, SDL_GetIMFCache(seq, len));
+	SDL_SendAudioCommand(AC_MusicStart, seq, len, startoffs, sqGeneration);
+}
+
+///////////////////////////////////////////////////////////////////////////
+//
+//      SD_StartMusic() - starts playing the music pointed to
+//
+///////////////////////////////////////////////////////////////////////////
+void
+SD_StartMusic(const char* chunk)
+{
 	SD_MusicOff();
 
 	if (MusicMode == smm_AdLib)
@@ -1485,30 +2434,23 @@ SD_StartMusic(const char* chunk)
 		// We assume that when music equals to NULL, we've an IMF file to play
 		if (music == NULL)
 		{
-			Mix_HookMusic(SDL_IMFMusicPlayer, 0);
-
-			SDL_LockMutex(audioMutex);
+			SDL_HookIMFPlayer(true);
 
-			for (int i = 0;i < OPL_CHANNELS;++i)
-				SDL_AlSetChanInst(&ChannelRelease, i);
+			// Make sure the audio thread is done with the old sequence
+			SDL_FlushAudioCommands();
 
-			sqHack = reinterpret_cast<word*>(chunkmem.Release());
-			sqHackFreeable = sqHack;
-			if(*sqHack == 0) sqHackLen = sqHackSeqLen = Wads.LumpLength(lumpNum);
-			else sqHackLen = sqHackSeqLen = LittleShort(*sqHack++);
-			sqHackPtr = sqHack;
-			sqHackTime = 0;
-			alTimeCount = 0;
-
-			SDL_UnlockMutex(audioMutex);
+			word *seq = reinterpret_cast<word*>(chunkmem.Release());
+			sqHackFreeable = seq;
+			int seqLen;
+			if(*seq == 0) seqLen = Wads.LumpLength(lumpNum);
+			else seqLen = LittleShort(*seq++);
+			SDL_StartSequence(seq, seqLen, 0);
 
 			SD_MusicOn();
 		}
 		else
 		{
-			Mix_HookMusic(0, 0);
-
-			SDL_LockMutex(audioMutex);
+			SDL_HookIMFPlayer(false);
 
 			// Play the music
 			musicchunk = lumpNum;
@@ -1516,8 +2458,6 @@ SD_StartMusic(const char* chunk)
 			{
 				printf("Unable to play music file: %s\n", Mix_GetError());
 			}
-
-			SDL_UnlockMutex(audioMutex);
 		}
 	}
 }
@@ -1533,9 +2473,12 @@ SD_ContinueMusic(const char* chunk, int startoffs)
 		if(lumpNum == -1)
 			return;
 
+		word *seq = NULL;
+		int seqLen = 0;
 		if (music == NULL || musicchunk != lumpNum)
 		{ // We need this scope to "delete" the lump before modifying the sqHack pointers.
-			SDL_LockMutex(audioMutex);
+			// Make sure the audio thread is done with the old sequence
+			SDL_FlushAudioCommands();
 			FWadLump lump = Wads.OpenLumpNum(lumpNum);
 			sqHackFreeable.Reset();
 			musicchunk = -1;
@@ -1551,50 +2494,27 @@ SD_ContinueMusic(const char* chunk, int startoffs)
 #endif
 			if (music == NULL)
 			{
-				sqHack = reinterpret_cast<word*>(chunkmem.Release());
-				sqHackFreeable = sqHack;
-				if(*sqHack == 0) sqHackLen = sqHackSeqLen = Wads.LumpLength(lumpNum);
-				else sqHackLen = sqHackSeqLen = LittleShort(*sqHack++);
-				sqHackPtr = sqHack;
+				seq = reinterpret_cast<word*>(chunkmem.Release());
+				sqHackFreeable = seq;
+				if(*seq == 0) seqLen = Wads.LumpLength(lumpNum);
+				else seqLen = LittleShort(*seq++);
 			}
 		}
 
 		if (music == NULL)
 		{
-			if(startoffs >= sqHackLen)
-			{
-				SDL_UnlockMutex(audioMutex);
+			if(startoffs >= seqLen)
 				Quit("SD_StartMusic: Illegal startoffs provided!");
-			}
-
-			// fast forward to correct position
-			// (needed to reconstruct the instruments)
-
-			for(int i = 0; i < startoffs; i += 2)
-			{
-				byte reg = *(byte *)sqHackPtr;
-				byte val = *(((byte *)sqHackPtr) + 1);
-				if(reg >= 0xb1 && reg <= 0xb8) val &= 0xdf;           // disable play note flag
-				else if(reg == 0xbd) val &= 0xe0;                     // disable drum flags
-
-				alOut(reg,val);
-				sqHackPtr += 2;
-				sqHackLen -= 4;
-			}
-			sqHackTime = 0;
-			alTimeCount = 0;
-
-			SDL_UnlockMutex(audioMutex);
 
-			Mix_HookMusic(SDL_IMFMusicPlayer, 0);
+			// The audio thread fast forwards to startoffs
+			SDL_HookIMFPlayer(true);
+			SDL_StartSequence(seq, seqLen, startoffs);
 
 			SD_MusicOn();
 		}
 		else
 		{
-			SDL_UnlockMutex(audioMutex);
-
-			Mix_HookMusic(0, 0);
+			SDL_HookIMFPlayer(false);
 
 			if (Mix_PausedMusic() == 1 && musicchunk == lumpNum)
 			{
@@ -1648,7 +2568,7 @@ bool SD_MusicPlaying(void)
 	{
 		case smm_AdLib:
 			if (music == NULL)
-				result = sqActive;	// not really thread-safe, but a mutex would be overkill
+				result = sqEnabled;
 			else
 				result = Mix_PlayingMusic() && !Mix_PausedMusic();
 			break;
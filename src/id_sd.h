@@ -99,6 +99,10 @@ typedef struct
 #define sqMaxTracks     10
 #define OPL_CHANNELS	9
 
+// Logical voices for digitized sounds. The first few are the fixed channels
+// in SoundChannel, the rest are handed out to SD_GENERIC sounds.
+#define SD_MAXVOICES	256
+
 typedef struct
 {
 	word    length;
@@ -123,6 +127,7 @@ extern  bool			AdLibPresent,
 extern  SDMode          SoundMode;
 extern  SDSMode         DigiMode;
 extern  SMMode          MusicMode;
+extern  SoundIndex      SoundPlaying;
 static const int MAX_VOLUME = 20;
 static inline double MULTIPLY_VOLUME(const int &v)
 {
@@ -159,7 +164,7 @@ extern  void    SD_Startup(void),
 extern  void    SD_PositionSound(int leftvol,int rightvol,int distance);
 extern  void    SD_SetLoopingPlay(bool looped);
 extern  void    SD_SetPlayVolume(double volume);
-extern  int		SD_PlaySound(const char* sound,SoundChannel chan=SD_GENERIC);
+extern  int		SD_PlaySound(const SoundIndex &sound,SoundChannel chan=SD_GENERIC);
 extern  void    SD_SetPosition(int channel, int leftvol, int rightvol, int distance);
 extern  void    SD_StopSound(void);
 extern  void    SD_WaitSoundDone(void);
@@ -178,8 +183,11 @@ extern  bool    SD_ChannelPlaying(SoundChannel chan);
 
 extern  void    SD_SetDigiDevice(SDSMode);
 extern  struct Mix_Chunk *SD_PrepareSound(int which);
+extern  struct Mix_Chunk *SD_DecodeSound(const void *data, int size);
 extern  int     SD_PlayDigitized(const SoundData &which,int leftpos,int rightpos,SoundChannel chan=SD_GENERIC,bool looping=false,int distance=0,double volume=1.0);
 extern  void    SD_StopDigitized(void);
 extern  void    SD_SetChannelVolume(int channel, double volume);
+extern  void    SD_HaltChannel(int channel);
+extern  void    SD_UpdateVoices(void);
 
 #endif
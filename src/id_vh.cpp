@@ -4,6 +4,7 @@
 #include "id_in.h"
 #include "id_vl.h"
 #include "id_vh.h"
+#include "wl_draw.h"
 #include "w_wad.h"
 #include "v_font.h"
 #include "v_palette.h"
@@ -12,6 +13,7 @@
 #include "textures/textures.h"
 #include "templates.h"
 #include "c_console.h"
+#include "m_capture.h"
 
 int	    pa=MENU_CENTER,px,py;
 
@@ -149,6 +151,8 @@ void Blit8BitSurfaceToTexture(SDL_Texture *tex, SDL_Surface *surf)
 
 void VH_UpdateScreen()
 {
+	R_SyncRefresh();
+	M_CaptureFrame();
 	screen->Update();
 	screen->Lock(false);
 }
@@ -196,6 +196,7 @@ class EVDoor : public Thinker
 							ChangeState(Opened);
 					}
 					spot->slideAmount[direction] = spot->slideAmount[direction+2] = amount;
+					GameMap::MarkChanged();
 					break;
 				case Opened:
 					if(wait == 0)
@@ -225,6 +226,7 @@ class EVDoor : public Thinker
 						map->LinkZones(zone1, zone2, false);
 					}
 					spot->slideAmount[direction] = spot->slideAmount[direction+2] = amount;
+					GameMap::MarkChanged();
 					break;
 			}
 		}
@@ -829,6 +831,7 @@ class EVPushwall : public Thinker
 				moveTo->SetTile(spot->tile);
 				moveTo->pushReceptor = spot;
 				moveTo->pushDirection = spot->pushDirection;
+				moveTo->UpdateFlags();
 
 				// Try to get a sound zone.
 				if(spot->zone == NULL)
@@ -847,12 +850,16 @@ class EVPushwall : public Thinker
 
 				// Transfer amflags
 				moveTo->amFlags |= spot->amFlags;
+				moveTo->UpdateFlags();
 
 				spot = moveTo;
 				moveTo = NULL;
 			}
 			else
+			{
 				spot->pushAmount = position/16;
+				spot->UpdateFlags();
+			}
 
 			if(!moveTo)
 			{
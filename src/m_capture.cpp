@@ -0,0 +1,378 @@
+/*
+** m_capture.cpp
+**
+** Screenshots and gameplay recording. The game thread only copies the frame
+** into a buffer from a fixed pool; PNG compression, palette expansion and
+** file I/O happen on the shared worker threads, one task per frame.
+**
+** Recordings are stamped against the wall clock, so a frame that stayed on
+** screen for several capture periods is written that many times and the
+** sequence plays back at the requested rate. When every pooled buffer is
+** still waiting to be encoded the game thread waits for one rather than
+** dropping the frame.
+**
+** Raw frames may be expanded out of order, so they are parked by sequence
+** number and whichever task completes the next one in line appends it and
+** any parked frames that follow. No task ever waits for another.
+*/
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+
+#include "wl_def.h"
+#include "filesys.h"
+#include "m_capture.h"
+#include "m_png.h"
+#include "m_workers.h"
+#include "v_palette.h"
+#include "v_video.h"
+#include "zdoomsupport.h"
+
+struct CaptureFrame
+{
+	TArray<BYTE> pixels;
+	TArray<BYTE> rgb;		// Expanded pixels of a raw recording frame
+	PalEntry palette[256];
+	int width, height, pitch;
+	ESSType colorType;
+
+	bool recorded;			// Part of a recording rather than a screenshot
+	FString filename;		// Screenshot name, unused for raw recordings
+	unsigned int sequence;	// First recording frame this stands for
+	unsigned int copies;	// Number of recording frames it stands for
+};
+
+static bool captureStarted = false;
+static std::mutex captureMutex;
+static std::condition_variable captureCond;
+static std::deque<CaptureFrame *> captureQueue;
+static TArray<CaptureFrame *> freeFrames;
+static unsigned int numFrames = 0, maxFrames = 0;
+static unsigned int framesBusy = 0;
+static std::map<unsigned int, CaptureFrame *> rawPending;	// Expanded, keyed by sequence
+static bool rawWriting = false;
+
+static struct
+{
+	bool active;
+	bool png;
+	unsigned int fps;
+	uint32_t start;
+	unsigned int framesQueued;	// Recording frames handed to the encoders
+	unsigned int rawNext;		// Next sequence number to go into rawFile
+	FString basename;
+	FILE *rawFile;
+	int width, height;
+} rec;
+
+static inline int BytesPerPixel(ESSType type)
+{
+	return type == SS_PAL ? 1 : type == SS_RGB ? 3 : 4;
+}
+
+static void WritePNG(const CaptureFrame *frame, const FString &filename)
+{
+	FILE *file = File(filename).open("wb");
+	if(!file)
+		return;
+	M_CreatePNG(file, &frame->pixels[0], frame->palette, frame->colorType, frame->width, frame->height, frame->pitch);
+	M_FinishPNG(file);
+	fclose(file);
+}
+
+// Must be called with captureMutex held.
+static void M_ReleaseFrame(CaptureFrame *frame)
+{
+	freeFrames.Push(frame);
+	--framesBusy;
+	captureCond.notify_all();
+}
+
+// Expands the frame to RGB24 and parks it until the raw stream gets to it.
+// The frame is released once it has been written.
+static void WriteRaw(CaptureFrame *frame, std::unique_lock<std::mutex> &lock)
+{
+	frame->rgb.Resize(frame->width*frame->height*3);
+	BYTE *out = &frame->rgb[0];
+	for(int y = 0; y < frame->height; ++y)
+	{
+		const BYTE *in = &frame->pixels[y*frame->pitch];
+		for(int x = 0; x < frame->width; ++x, out += 3)
+		{
+			switch(frame->colorType)
+			{
+				case SS_PAL:
+				{
+					const PalEntry &c = frame->palette[in[x]];
+					out[0] = c.r; out[1] = c.g; out[2] = c.b;
+					break;
+				}
+				case SS_RGB:
+					out[0] = in[x*3]; out[1] = in[x*3+1]; out[2] = in[x*3+2];
+					break;
+				case SS_BGRA:
+					out[0] = in[x*4+2]; out[1] = in[x*4+1]; out[2] = in[x*4];
+					break;
+			}
+		}
+	}
+
+	lock.lock();
+	rawPending[frame->sequence] = frame;
+	// Whoever is writing will pick this one up too if it is next.
+	if(rawWriting)
+	{
+		lock.unlock();
+		return;
+	}
+
+	rawWriting = true;
+	std::map<unsigned int, CaptureFrame *>::iterator next;
+	while((next = rawPending.find(rec.rawNext)) != rawPending.end())
+	{
+		CaptureFrame *ready = next->second;
+		rawPending.erase(next);
+		FILE *file = rec.rawFile;
+		lock.unlock();
+
+		if(file)
+		{
+			for(unsigned int i = 0; i < ready->copies; ++i)
+				fwrite(&ready->rgb[0], 1, ready->rgb.Size(), file);
+		}
+
+		lock.lock();
+		rec.rawNext += ready->copies;
+		M_ReleaseFrame(ready);
+	}
+	rawWriting = false;
+	lock.unlock();
+}
+
+// Returns false if the frame was handed on to be released later.
+static bool EncodeFrame(CaptureFrame *frame, std::unique_lock<std::mutex> &lock)
+{
+	if(!frame->recorded)
+	{
+		WritePNG(frame, frame->filename);
+		return true;
+	}
+
+	if(!frame->filename.IsEmpty())
+	{
+		// A PNG sequence writes repeated frames under each number they cover.
+		for(unsigned int i = 0; i < frame->copies; ++i)
+		{
+			FString name;
+			name.Format("%s_%06u.png", frame->filename.GetChars(), frame->sequence + i);
+			WritePNG(frame, name);
+		}
+		return true;
+	}
+
+	WriteRaw(frame, lock);
+	return false;
+}
+
+// Posted once per queued frame. The worker pool starts tasks in the order
+// they were posted so the frames are taken in sequence.
+static void M_EncodeNextFrame()
+{
+	std::unique_lock<std::mutex> lock(captureMutex);
+	CaptureFrame *frame = captureQueue.front();
+	captureQueue.pop_front();
+	lock.unlock();
+
+	if(EncodeFrame(frame, lock))
+	{
+		lock.lock();
+		M_ReleaseFrame(frame);
+	}
+}
+
+static void M_FreeCaptureFrames()
+{
+	M_StopRecording();
+	M_FlushCaptures();
+
+	for(unsigned int i = 0; i < freeFrames.Size(); ++i)
+		delete freeFrames[i];
+	freeFrames.Clear();
+	numFrames = 0;
+}
+
+// Takes a buffer out of the pool, waiting for the encoders to give one back
+// if all of them are in flight.
+static CaptureFrame *M_GetFrame()
+{
+	if(!captureStarted)
+	{
+		captureStarted = true;
+		maxFrames = clamp<unsigned int>(Workers::NumThreads(), 1, 4)*2 + 1;
+		atterm(M_FreeCaptureFrames);
+	}
+
+	std::unique_lock<std::mutex> lock(captureMutex);
+	if(freeFrames.Size() == 0 && numFrames < maxFrames)
+	{
+		freeFrames.Push(new CaptureFrame);
+		++numFrames;
+	}
+	captureCond.wait(lock, [] { return freeFrames.Size() != 0; });
+
+	CaptureFrame *frame;
+	freeFrames.Pop(frame);
+	++framesBusy;
+	return frame;
+}
+
+static void M_QueueFrame(CaptureFrame *frame)
+{
+	{
+		std::lock_guard<std::mutex> lock(captureMutex);
+		captureQueue.push_back(frame);
+	}
+	Workers::Post(M_EncodeNextFrame);
+}
+
+// Copies the visible screen into frame. Returns false if there is nothing to
+// copy.
+static bool M_CopyScreen(CaptureFrame *frame)
+{
+	const BYTE *buffer;
+	int pitch;
+	screen->GetScreenshotBuffer(buffer, pitch, frame->colorType);
+	if(buffer == NULL)
+	{
+		screen->ReleaseScreenshotBuffer();
+		return false;
+	}
+
+	frame->width = SCREENWIDTH;
+	frame->height = SCREENHEIGHT;
+	frame->pitch = frame->width*BytesPerPixel(frame->colorType);
+	frame->pixels.Resize(frame->pitch*frame->height);
+	for(int y = 0; y < frame->height; ++y)
+		memcpy(&frame->pixels[y*frame->pitch], buffer + y*pitch, frame->pitch);
+	screen->ReleaseScreenshotBuffer();
+
+	memcpy(frame->palette, GPalette.BaseColors, sizeof(frame->palette));
+	return true;
+}
+
+void M_CaptureScreenshot(const FString &filename)
+{
+	CaptureFrame *frame = M_GetFrame();
+	if(!M_CopyScreen(frame))
+	{
+		std::lock_guard<std::mutex> lock(captureMutex);
+		M_ReleaseFrame(frame);
+		return;
+	}
+
+	frame->recorded = false;
+	frame->filename = filename;
+	frame->sequence = 0;
+	frame->copies = 1;
+	M_QueueFrame(frame);
+}
+
+void M_StartRecording(unsigned int fps, bool png)
+{
+	if(rec.active || fps == 0)
+		return;
+
+	FString dir = FileSys::GetDirectoryPath(FileSys::DIR_Screenshots);
+	FString basename;
+	for(unsigned int i = 0; i < 1000; ++i)
+	{
+		basename.Format("%s" PATH_SEPARATOR "capture%03u", dir.GetChars(), i);
+		if(!File(basename + "_000000.png").exists() && !File(basename + ".rgb").exists())
+			break;
+	}
+
+	rec.png = png;
+	rec.fps = fps;
+	rec.basename = basename;
+	rec.width = SCREENWIDTH;
+	rec.height = SCREENHEIGHT;
+	rec.rawFile = NULL;
+	rec.framesQueued = 0;
+	rec.rawNext = 0;
+	if(!png)
+	{
+		rec.rawFile = File(basename + ".rgb").open("wb");
+		if(!rec.rawFile)
+		{
+			Printf("Could not open %s.rgb for recording.\n", basename.GetChars());
+			return;
+		}
+		Printf("Recording %dx%d rgb24 at %u fps to %s.rgb\n", rec.width, rec.height, fps, basename.GetChars());
+	}
+	else
+		Printf("Recording %u fps PNG sequence to %s_*.png\n", fps, basename.GetChars());
+
+	rec.start = SDL_GetTicks();
+	rec.active = true;
+}
+
+void M_StopRecording()
+{
+	if(!rec.active)
+		return;
+
+	rec.active = false;
+	M_FlushCaptures();
+	if(rec.rawFile)
+	{
+		fclose(rec.rawFile);
+		rec.rawFile = NULL;
+	}
+}
+
+bool M_IsRecording()
+{
+	return rec.active;
+}
+
+void M_CaptureFrame()
+{
+	if(!rec.active)
+		return;
+
+	// A raw stream can't change size part way through.
+	if(SCREENWIDTH != rec.width || SCREENHEIGHT != rec.height)
+	{
+		Printf("Screen size changed, recording stopped.\n");
+		M_StopRecording();
+		return;
+	}
+
+	const unsigned int due = (uint64_t)(SDL_GetTicks() - rec.start)*rec.fps/1000 + 1;
+	if(due <= rec.framesQueued)
+		return;
+
+	CaptureFrame *frame = M_GetFrame();
+	if(!M_CopyScreen(frame))
+	{
+		// Try again next frame, the missing period will be filled then.
+		std::lock_guard<std::mutex> lock(captureMutex);
+		M_ReleaseFrame(frame);
+		return;
+	}
+
+	frame->recorded = true;
+	frame->filename = rec.png ? rec.basename : FString();
+	frame->sequence = rec.framesQueued;
+	frame->copies = due - rec.framesQueued;
+	rec.framesQueued = due;
+	M_QueueFrame(frame);
+}
+
+void M_FlushCaptures()
+{
+	std::unique_lock<std::mutex> lock(captureMutex);
+	captureCond.wait(lock, [] { return framesBusy == 0; });
+}
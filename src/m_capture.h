@@ -0,0 +1,33 @@
+#ifndef __M_CAPTURE_H__
+#define __M_CAPTURE_H__
+
+#include "zstring.h"
+
+/*
+=============================================================================
+
+						FRAME CAPTURE
+
+ The frame is copied into a pooled buffer on the game thread and the encoding
+ and writing is left to background threads, so neither a screenshot nor a
+ recording holds up the frame that was captured.
+
+=============================================================================
+*/
+
+// Queues the current screen to be written to filename as a PNG.
+void M_CaptureScreenshot(const FString &filename);
+
+// Records the presented frames at fps into the screenshots directory, either
+// as a numbered PNG sequence or as one raw RGB24 stream.
+void M_StartRecording(unsigned int fps, bool png);
+void M_StopRecording();
+bool M_IsRecording();
+
+// Called by VH_UpdateScreen before the frame is presented.
+void M_CaptureFrame();
+
+// Blocks until everything queued so far is on disk.
+void M_FlushCaptures();
+
+#endif
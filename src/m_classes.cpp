@@ -1000,7 +1000,7 @@ int Menu::handle()
 	{
 		case 1:
 			if(getIndex(curPos)->playActivateSound())
-				SD_PlaySound (getIndex(curPos)->getActivateSound());
+				SD_PlaySound (getIndex(curPos)->getActivateSound().GetChars());
 			getIndex(curPos)->activate();
 			PrintX = getX() + getIndent();
 			PrintY = getY() + getHeight(curPos);
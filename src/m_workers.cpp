@@ -0,0 +1,186 @@
+/*
+** m_workers.cpp
+**
+** Persistent worker threads. Tasks are taken first in first out, so work
+** that must finish in order (such as recorded frames) is started in the order
+** it was posted. On shutdown the queue is drained before the threads exit.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "wl_def.h"
+#include "m_workers.h"
+
+namespace Workers
+{
+
+static std::vector<std::thread> threads;
+static std::mutex queueMutex;
+static std::condition_variable queueCond;
+static std::deque<std::function<void()> > queue;
+static bool started = false, quit = false;
+
+static void WorkerThread()
+{
+	std::unique_lock<std::mutex> lock(queueMutex);
+	while(true)
+	{
+		queueCond.wait(lock, [] { return !queue.empty() || quit; });
+		if(queue.empty())
+			break;
+
+		std::function<void()> task = std::move(queue.front());
+		queue.pop_front();
+		lock.unlock();
+
+		task();
+
+		lock.lock();
+	}
+}
+
+static void StopWorkers()
+{
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		quit = true;
+	}
+	queueCond.notify_all();
+	for(std::thread &thread : threads)
+		thread.join();
+	threads.clear();
+}
+
+// Must be called with queueMutex held.
+static void StartWorkers()
+{
+	started = true;
+	const unsigned int numThreads = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+	for(unsigned int i = 0; i < numThreads; ++i)
+		threads.push_back(std::thread(WorkerThread));
+	atterm(StopWorkers);
+}
+
+unsigned int NumThreads()
+{
+	std::lock_guard<std::mutex> lock(queueMutex);
+	if(!started)
+		StartWorkers();
+	return threads.size();
+}
+
+void Post(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		if(!started)
+			StartWorkers();
+		if(!quit)
+		{
+			queue.push_back(std::move(task));
+			queueCond.notify_one();
+			return;
+		}
+	}
+	task();
+}
+
+// Shared with the helpers since a helper may only get to run after the call
+// that posted it has returned. Such a helper finds nothing left and never
+// touches job.
+struct ForState
+{
+	std::atomic<size_t> next;
+	size_t count;
+	const std::function<void(size_t)> *job;
+
+	std::mutex mutex;
+	std::condition_variable done;
+	unsigned int active;
+};
+
+static void RunFor(ForState &state)
+{
+	size_t i;
+	while((i = state.next++) < state.count)
+		(*state.job)(i);
+}
+
+void ParallelFor(size_t count, const std::function<void(size_t)> &job)
+{
+	if(count == 0)
+		return;
+
+	const size_t numHelpers = std::min<size_t>(count, NumThreads() + 1) - 1;
+	if(numHelpers == 0)
+	{
+		for(size_t i = 0; i < count; ++i)
+			job(i);
+		return;
+	}
+
+	std::shared_ptr<ForState> state = std::make_shared<ForState>();
+	state->next = 0;
+	state->count = count;
+	state->job = &job;
+	state->active = 0;
+
+	for(size_t i = 0; i < numHelpers; ++i)
+	{
+		Post([state]()
+		{
+			{
+				std::lock_guard<std::mutex> lock(state->mutex);
+				if(state->next >= state->count)
+					return;
+				++state->active;
+			}
+
+			RunFor(*state);
+
+			std::lock_guard<std::mutex> lock(state->mutex);
+			if(--state->active == 0)
+				state->done.notify_all();
+		});
+	}
+
+	RunFor(*state);
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->done.wait(lock, [&state] { return state->active == 0; });
+}
+
+bool Group::Busy()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return pending != 0;
+}
+
+void Group::Run(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		++pending;
+	}
+	Post([this, task]()
+	{
+		task();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if(--pending == 0)
+			done.notify_all();
+	});
+}
+
+void Group::Wait()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [this] { return pending == 0; });
+}
+
+}
@@ -0,0 +1,51 @@
+#ifndef __M_WORKERS_H__
+#define __M_WORKERS_H__
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+/*
+=============================================================================
+
+						WORKER POOL
+
+ A fixed set of threads shared by everything that splits work across cores.
+ The threads are started on first use and kept until shutdown, so jobs which
+ run every frame only pay for waking them up.
+
+=============================================================================
+*/
+
+namespace Workers
+{
+	// Number of pool threads, not counting the caller.
+	unsigned int NumThreads();
+
+	// Queues task to run on a pool thread. After shutdown the task is run
+	// immediately on the calling thread instead.
+	void Post(std::function<void()> task);
+
+	// Calls job(i) for every i below count, spread over the pool and the
+	// calling thread. Returns once all of them have finished.
+	void ParallelFor(size_t count, const std::function<void(size_t)> &job);
+
+	// Tracks a batch of posted tasks so that the owner can wait for them.
+	class Group
+	{
+	public:
+		Group() : pending(0) {}
+		~Group() { Wait(); }
+
+		bool Busy();
+		void Run(std::function<void()> task);
+		void Wait();
+
+	private:
+		std::mutex mutex;
+		std::condition_variable done;
+		unsigned int pending;
+	};
+}
+
+#endif
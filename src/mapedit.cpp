@@ -328,6 +328,7 @@ AdjustGameMap::AdjustGameMap() : spot(NULL), tile(NULL), sector(NULL)
 			sector = spot->sector;
 			spot->SetTile(NULL);
 			spot->sector = &mapeditor->markedSector;
+			GameMap::MarkChanged();
 		}
 	}
 }
@@ -338,6 +339,7 @@ AdjustGameMap::~AdjustGameMap()
 	{
 		spot->SetTile(tile);
 		spot->sector = sector;
+		GameMap::MarkChanged();
 	}
 }
 
@@ -449,6 +451,8 @@ public:
 		}
 
 		spot->sector = sector;
+		GameMap::MarkChanged();
+		map->SpotChanged(spot);
 		return true;
 	}
 };
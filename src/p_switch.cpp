@@ -277,6 +277,7 @@ bool P_ChangeSwitchTexture (MapSpot spot, MapTile::Side side, int useAgain, BYTE
 	pt[0] = spot->GetX();
 	pt[1] = spot->GetY();
 	spot->texture[side] = Switch->frames[0].Texture;
+	GameMap::MarkChanged();
 	if (useAgain || Switch->NumFrames > 1)
 	{
 		playsound = P_StartButton (spot, side, Switch, pt[0], pt[1], !!useAgain);
@@ -289,7 +290,7 @@ bool P_ChangeSwitchTexture (MapSpot spot, MapTile::Side side, int useAgain, BYTE
 	{
 		//FName test = "switches/normbutn";
 		//Printf("Here %d %s %d %s\n", (int)test, test.GetChars(), (int)sound, sound.GetChars());
-		SD_PlaySound(FName(sound).GetChars());
+		SD_PlaySound(FName(sound));
 		//PlaySoundLocMapSpot(FName(sound), spot);
 	}
 	if (quest != NULL)
@@ -391,6 +392,7 @@ void DActiveButton::Tick ()
 		bool killme = AdvanceFrame ();
 
 		m_Spot->texture[m_Side] = def->frames[m_Frame].Texture;
+		GameMap::MarkChanged();
 
 		if (killme)
 		{
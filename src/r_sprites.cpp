@@ -374,7 +374,6 @@ void R_LoadSprite(const FString &name)
 ////////////////////////////////////////////////////////////////////////////////
 
 // From wl_draw.cpp
-unsigned int CalcRotate(AActor *ob);
 extern byte* vbuf;
 extern unsigned vbufPitch;
 extern fixed viewshift;
@@ -392,7 +391,7 @@ namespace Shading
 	const ClassDef *LitForPix ();
 }
 
-void ScaleSprite(AActor *actor, int xcenter, const Frame *frame, unsigned height)
+void ScaleSprite(const R_VisSprite &actor, int xcenter, const Frame *frame, unsigned height)
 {
 	// height is a 13.3 fixed point number indicating the number of screen
 	// pixels that the sprite should occupy.
@@ -403,21 +402,21 @@ void ScaleSprite(AActor *actor, int xcenter, const Frame *frame, unsigned height
 	// Simpler form:
 	// topoffset = ( viewheight/2 - viewshift - (signed(height>>3)*(viewz+(32<<FRACBITS))/(32<<FRACBITS)) )<<3;
 	const int topoffset = (viewheight<<2) - (viewshift<<3) -
-	                      FixedMul(height, (viewz+(actor->z<<6)+(32<<FRACBITS))>>5);
+	                      FixedMul(height, (viewz+(actor.z<<6)+(32<<FRACBITS))>>5);
 	if(-topoffset >= (signed)height)
 		return;
 
-	if(actor->sprite == SPR_NONE || loadedSprites[actor->sprite].numFrames == 0)
+	if(actor.sprite == SPR_NONE || loadedSprites[actor.sprite].numFrames == 0)
 		return;
 
-	bool flip = (actor->FlipSprite);
-	const Sprite &spr = spriteFrames[loadedSprites[actor->sprite].frames+frame->frame];
+	bool flip = actor.flip;
+	const Sprite &spr = spriteFrames[loadedSprites[actor.sprite].frames+frame->frame];
 	FTexture *tex;
 	if(spr.rotations == 0)
 		tex = TexMan[spr.texture[0]];
 	else
 	{
-		const unsigned int rot = CalcRotate(actor);
+		const unsigned int rot = actor.rotation;
 		tex = TexMan[spr.texture[rot]];
 		if ((spr.mirror>>rot)&1)
 			flip = !flip;
@@ -425,10 +424,10 @@ void ScaleSprite(AActor *actor, int xcenter, const Frame *frame, unsigned height
 	if(tex == NULL)
 		return;
 
-	const double dyScale = (height/256.0)*FIXED2FLOAT(actor->scaleY);
+	const double dyScale = (height/256.0)*FIXED2FLOAT(actor.scaleY);
 	const int upperedge = topoffset + height - static_cast<int>((tex->GetScaledTopOffsetDouble())*dyScale*8);
 
-	const double dxScale = (height/256.0)*FIXED2FLOAT(FixedDiv(actor->scaleX, yaspect));
+	const double dxScale = (height/256.0)*FIXED2FLOAT(FixedDiv(actor.scaleX, yaspect));
 	const int actx = static_cast<int>(xcenter - tex->GetScaledLeftOffsetDouble()*dxScale);
 
 	const unsigned int texWidth = tex->GetWidth();
@@ -440,16 +439,16 @@ void ScaleSprite(AActor *actor, int xcenter, const Frame *frame, unsigned height
 	const fixed yRun = MIN<fixed>(tex->GetHeight()<<FRACBITS, (yStep*((viewheight<<3)-upperedge))>>3);
 
 	const BYTE *colormap;
-	if((actor->flags & FL_BRIGHT) || frame->fullbright)
+	if(actor.bright || frame->fullbright)
 		colormap = NormalLight.Maps;
 	else
 	{
-		const int shade = LIGHT2SHADE(gLevelLight + r_extralight + Shading::LightForIntercept (actor->absx, actor->absy));
+		const int shade = LIGHT2SHADE(gLevelLight + r_extralight + Shading::LightForIntercept (actor.absx, actor.absy));
 		const int tz = FixedMul(r_depthvisibility<<8, height);
 		colormap = &NormalLight.Maps[GETPALOOKUP(MAX(tz, MINZ), shade)<<8];
 	}
 
-	const ClassDef * const litfilter = actor->litfilter;
+	const ClassDef * const litfilter = actor.litfilter;
 	if (litfilter != NULL)
 	{
 		//std::cerr << actor << " " << (upperedge>>3) << " " << actor->z << " " << tex->GetScaledTopOffsetDouble() << std::endl;
@@ -492,9 +491,9 @@ void ScaleSprite(AActor *actor, int xcenter, const Frame *frame, unsigned height
 	}
 }
 
-void Scale3DSpriter(AActor *actor, int x1, int x2, FTexture *tex, bool flip, const Frame *frame, fixed ny1, fixed ny2, fixed nx1, fixed nx2)
+void Scale3DSpriter(const R_VisSprite &actor, int x1, int x2, FTexture *tex, bool flip, const Frame *frame, fixed ny1, fixed ny2, fixed nx1, fixed nx2)
 {
-	if(actor->sprite == SPR_NONE || loadedSprites[actor->sprite].numFrames == 0)
+	if(actor.sprite == SPR_NONE || loadedSprites[actor.sprite].numFrames == 0)
 		return;
 
 	const unsigned int texWidth = tex->GetWidth();
@@ -504,12 +503,12 @@ void Scale3DSpriter(AActor *actor, int x1, int x2, FTexture *tex, bool flip, con
 	unsigned height = height1;
 
 	int scale = height>>3; // Integer part of the height
-	int topoffset = (scale*(viewz+(actor->z<<6)+(32<<FRACBITS))/(32<<FRACBITS));
+	int topoffset = (scale*(viewz+(actor.z<<6)+(32<<FRACBITS))/(32<<FRACBITS));
 
 	if(scale == 0 || -(viewheight/2 - viewshift - topoffset) >= scale)
 		return;
 
-	double dyScale = (height/256.0)*(actor->scaleY/65536.);
+	double dyScale = (height/256.0)*(actor.scaleY/65536.);
 	int upperedge = static_cast<int>((viewheight/2 - viewshift - topoffset)+scale - tex->GetScaledTopOffsetDouble()*dyScale);
 	
 	fixed yStep = static_cast<fixed>(tex->yScale/dyScale);
@@ -518,11 +517,11 @@ void Scale3DSpriter(AActor *actor, int x1, int x2, FTexture *tex, bool flip, con
 
 	// [XA] TODO: shade the sprite per-column?
 	const BYTE *colormap;
-	if((actor->flags & FL_BRIGHT) || frame->fullbright)
+	if(actor.bright || frame->fullbright)
 		colormap = NormalLight.Maps;
 	else
 	{
-		const int shade = LIGHT2SHADE(gLevelLight + r_extralight + Shading::LightForIntercept (actor->x, actor->y));
+		const int shade = LIGHT2SHADE(gLevelLight + r_extralight + Shading::LightForIntercept (actor.x, actor.y));
 		const int tz = FixedMul(r_depthvisibility<<8, height);
 		colormap = &NormalLight.Maps[GETPALOOKUP(MAX(tz, MINZ), shade)<<8];
 	}
@@ -557,7 +556,7 @@ void Scale3DSpriter(AActor *actor, int x1, int x2, FTexture *tex, bool flip, con
 
 		// recalculation double oh no
 		scale = height>>3;
-		topoffset = (scale*(viewz+(actor->z<<6)+(32<<FRACBITS))/(32<<FRACBITS));
+		topoffset = (scale*(viewz+(actor.z<<6)+(32<<FRACBITS))/(32<<FRACBITS));
 
 		if(i < 0 || i >= viewwidth || wallheight[i][0] > (signed)height || scale == 0 || -(viewheight/2 - viewshift - topoffset) >= scale)
 			continue;
@@ -570,7 +569,7 @@ void Scale3DSpriter(AActor *actor, int x1, int x2, FTexture *tex, bool flip, con
 			dest += vbufPitch;
 		}
 
-		dyScale = (height/256.0)*(actor->scaleY/65536.);
+		dyScale = (height/256.0)*(actor.scaleY/65536.);
 		upperedge = static_cast<int>((viewheight/2 - viewshift - topoffset)+scale - tex->GetScaledTopOffsetDouble()*dyScale);
 		
 		yStep = static_cast<fixed>(tex->yScale/dyScale);
@@ -583,16 +582,16 @@ bool UseWolf4SDL3DSpriteScaler = false;
 void Scale3DShaper(int, int, FTexture *, uint32_t, fixed, fixed, fixed, fixed, byte *, unsigned);
 
 // This function from Wolf4SDL more or less verbatim at the moment.
-void Scale3DSprite(AActor *actor, const Frame *frame, unsigned height)
+void Scale3DSprite(const R_VisSprite &actor, const Frame *frame, unsigned height)
 {
 	bool flip = false;
-	const Sprite &spr = spriteFrames[loadedSprites[actor->sprite].frames+frame->frame];
+	const Sprite &spr = spriteFrames[loadedSprites[actor.sprite].frames+frame->frame];
 	FTexture *tex;
 	if(spr.rotations == 0)
 		tex = TexMan[spr.texture[0]];
 	else
 	{
-		const unsigned int rot = CalcRotate(actor);
+		const unsigned int rot = actor.rotation;
 		tex = TexMan[spr.texture[rot]];
 		flip = (spr.mirror>>rot)&1;
 	}
@@ -608,12 +607,12 @@ void Scale3DSprite(AActor *actor, const Frame *frame, unsigned height)
 	fixed gy1,gy2,gx1,gx2,gyt1,gyt2,gxt1,gxt2;
 
 	// translate point to view centered coordinates
-	const fixed scaledOffset = FixedMul(FLOAT2FIXED(tex->GetScaledLeftOffsetDouble()), actor->scaleX);
-	const fixed scaledWidth = FixedMul(FLOAT2FIXED(tex->GetScaledWidthDouble()), actor->scaleX);
-	gy1 = actor->y-playy-(FixedMul(scaledOffset, finecosine[actor->angle>>ANGLETOFINESHIFT])>>6);
-	gy2 = gy1+(FixedMul(scaledWidth, finecosine[actor->angle>>ANGLETOFINESHIFT])>>6);
-	gx1 = actor->x-playx-(FixedMul(scaledOffset, finesine[actor->angle>>ANGLETOFINESHIFT])>>6);
-	gx2 = gx1+(FixedMul(scaledWidth, finesine[actor->angle>>ANGLETOFINESHIFT])>>6);
+	const fixed scaledOffset = FixedMul(FLOAT2FIXED(tex->GetScaledLeftOffsetDouble()), actor.scaleX);
+	const fixed scaledWidth = FixedMul(FLOAT2FIXED(tex->GetScaledWidthDouble()), actor.scaleX);
+	gy1 = actor.y-playy-(FixedMul(scaledOffset, finecosine[actor.angle>>ANGLETOFINESHIFT])>>6);
+	gy2 = gy1+(FixedMul(scaledWidth, finecosine[actor.angle>>ANGLETOFINESHIFT])>>6);
+	gx1 = actor.x-playx-(FixedMul(scaledOffset, finesine[actor.angle>>ANGLETOFINESHIFT])>>6);
+	gx2 = gx1+(FixedMul(scaledWidth, finesine[actor.angle>>ANGLETOFINESHIFT])>>6);
 	
 	// calculate newx
 	gxt1 = FixedMul(gx1,viewcos);
@@ -667,8 +666,12 @@ void Scale3DSprite(AActor *actor, const Frame *frame, unsigned height)
 	}
 }
 
-void R_DrawPlayerSprite(AActor *actor, const Frame *frame, fixed offsetX, fixed offsetY)
+void R_DrawPlayerSprite(const R_PlayerSprite &psprite)
 {
+	const Frame * const frame = psprite.frame;
+	const fixed offsetX = psprite.offsetX;
+	const fixed offsetY = psprite.offsetY;
+
 	if(frame->spriteInf == SPR_NONE || loadedSprites[frame->spriteInf].numFrames == 0)
 		return;
 
@@ -677,7 +680,7 @@ void R_DrawPlayerSprite(AActor *actor, const Frame *frame, fixed offsetX, fixed
 	if(spr.rotations == 0)
 		tex = TexMan[spr.texture[0]];
 	else
-		tex = TexMan[spr.texture[(CalcRotate(actor)+4)%8]];
+		tex = TexMan[spr.texture[(psprite.rotation+4)%8]];
 	if(tex == NULL)
 		return;
 
@@ -703,9 +706,9 @@ void R_DrawPlayerSprite(AActor *actor, const Frame *frame, fixed offsetX, fixed
 	const fixed centeringOffset = (centerx - 2*centerxwide)<<FRACBITS;
 	const fixed leftedge = FixedMul((160<<FRACBITS) - fixed(tex->GetScaledLeftOffsetDouble()*FRACUNIT) + offsetX, pspritexscale) + centeringOffset;
 	fixed upperedge = ((100-32)<<FRACBITS) + fixed(tex->GetScaledTopOffsetDouble()*FRACUNIT) - offsetY - AspectCorrection[r_ratio].tallscreen;
-	if(viewsize == 21 && players[ConsolePlayer].ReadyWeapon)
+	if(viewsize == 21)
 	{
-		upperedge -= players[ConsolePlayer].ReadyWeapon->yadjust;
+		upperedge -= psprite.yadjust;
 	}
 	upperedge = scale - FixedMul(upperedge, pspriteyscale);
 
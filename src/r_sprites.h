@@ -53,9 +53,36 @@ void R_GetSpriteHitlist(BYTE* hitlist);
 void R_InitSprites();
 void R_LoadSprite(const FString &name);
 
-void ScaleSprite(AActor *actor, int xcenter, const Frame *frame, unsigned height);
-void Scale3DSprite(AActor *actor, const Frame *frame, unsigned height);
-void R_DrawPlayerSprite(AActor *actor, const Frame *frame, fixed offsetX, fixed offsetY);
+// Copy of the actor state that the sprite drawers need. This is filled in
+// on the main thread so that sprites can be drawn while the next tic runs.
+struct R_VisSprite
+{
+	const Frame		*frame;
+	unsigned int	sprite;
+	unsigned int	rotation;
+	fixed			x, y, z;
+	angle_t			angle;
+	fixed			scaleX, scaleY;
+	fixed			absx, absy;
+	const ClassDef	*litfilter;
+	short			viewx;
+	word			viewheight;
+	bool			flip;
+	bool			bright;
+	bool			billboard;
+};
+
+struct R_PlayerSprite
+{
+	const Frame		*frame;
+	fixed			offsetX, offsetY;
+	unsigned int	rotation;
+	fixed			yadjust;
+};
+
+void ScaleSprite(const R_VisSprite &actor, int xcenter, const Frame *frame, unsigned height);
+void Scale3DSprite(const R_VisSprite &actor, const Frame *frame, unsigned height);
+void R_DrawPlayerSprite(const R_PlayerSprite &psprite);
 
 // For FArchive
 unsigned int R_GetNumLoadedSprites();
@@ -57,6 +57,7 @@ public:
 	int	Position;
 
 	int GetFileOffset() { return Position; }
+	bool CanCacheConcurrently() const { return !Compressed; }
 	FileReader *GetReader()
 	{
 		if(!Compressed)
@@ -81,16 +82,16 @@ public:
 			}
 		}
 
-		Owner->Reader->Seek(Position, SEEK_SET);
 		Cache = new char[LumpSize];
 
 		if(Compressed)
 		{
+			Owner->Reader->Seek(Position, SEEK_SET);
 			FileReaderLZSS lzss(*Owner->Reader);
 			lzss.Read(Cache, LumpSize);
 		}
 		else
-			Owner->Reader->Read(Cache, LumpSize);
+			Owner->Reader->ReadAt(Cache, LumpSize, Position);
 
 		RefCount = 1;
 		return 1;
@@ -113,6 +113,7 @@ struct FZipLump : public FResourceLump
 
 	virtual FileReader *GetReader();
 	virtual int FillCache();
+	virtual bool CanCacheConcurrently() const { return true; }
 
 private:
 	void SetLumpAddress();
@@ -289,10 +290,7 @@ void FZipLump::SetLumpAddress()
 	FZipLocalFileHeader localHeader;
 	int skiplen;
 
-	FileReader *file = Owner->Reader;
-
-	file->Seek(Position, SEEK_SET);
-	file->Read(&localHeader, sizeof(localHeader));
+	Owner->Reader->ReadAt(&localHeader, sizeof(localHeader), Position);
 	skiplen = LittleShort(localHeader.NameLength) + LittleShort(localHeader.ExtraLength);
 	Position += sizeof(localHeader) + skiplen;
 	Flags &= ~LUMPFZIP_NEEDFILESTART;
@@ -328,7 +326,8 @@ int FZipLump::FillCache()
 	if (Flags & LUMPFZIP_NEEDFILESTART) SetLumpAddress();
 	const char *buffer;
 
-	if (Method == METHOD_STORED && (buffer = Owner->Reader->GetBuffer()) != NULL)
+	buffer = Owner->Reader->GetBuffer();
+	if (Method == METHOD_STORED && buffer != NULL)
 	{
 		// This is an in-memory file so the cache can point directly to the file's data.
 		Cache = const_cast<char*>(buffer) + Position;
@@ -336,33 +335,48 @@ int FZipLump::FillCache()
 		return -1;
 	}
 
-	Owner->Reader->Seek(Position, SEEK_SET);
 	Cache = new char[LumpSize];
-	switch (Method)
+	if (Method == METHOD_STORED)
 	{
-		case METHOD_STORED:
-		{
-			Owner->Reader->Read(Cache, LumpSize);
-			break;
-		}
+		Owner->Reader->ReadAt(Cache, LumpSize, Position);
+		RefCount = 1;
+		return 1;
+	}
 
+	// Decompress from a private reader so the archive's position is left
+	// alone and several lumps can be inflated at once.
+	TArray<char> packed;
+	if (buffer != NULL)
+	{
+		buffer += Position;
+	}
+	else
+	{
+		packed.Resize(MAX(CompressedSize, 1));
+		Owner->Reader->ReadAt(&packed[0], CompressedSize, Position);
+		buffer = &packed[0];
+	}
+	MemoryReader source(buffer, CompressedSize);
+
+	switch (Method)
+	{
 		case METHOD_DEFLATE:
 		{
-			FileReaderZ frz(*Owner->Reader, true);
+			FileReaderZ frz(source, true);
 			frz.Read(Cache, LumpSize);
 			break;
 		}
 
 		case METHOD_BZIP2:
 		{
-			FileReaderBZ2 frz(*Owner->Reader);
+			FileReaderBZ2 frz(source);
 			frz.Read(Cache, LumpSize);
 			break;
 		}
 
 		case METHOD_LZMA:
 		{
-			FileReaderLZMA frz(*Owner->Reader, LumpSize, true);
+			FileReaderLZMA frz(source, LumpSize, true);
 			frz.Read(Cache, LumpSize);
 			break;
 		}
@@ -370,13 +384,13 @@ int FZipLump::FillCache()
 		case METHOD_IMPLODE:
 		{
 			FZipExploder exploder;
-			exploder.Explode((unsigned char *)Cache, LumpSize, Owner->Reader, CompressedSize, GPFlags);
+			exploder.Explode((unsigned char *)Cache, LumpSize, &source, CompressedSize, GPFlags);
 			break;
 		}
 
 		case METHOD_SHRINK:
 		{
-			ShrinkLoop((unsigned char *)Cache, LumpSize, Owner->Reader, CompressedSize);
+			ShrinkLoop((unsigned char *)Cache, LumpSize, &source, CompressedSize);
 			break;
 		}
 
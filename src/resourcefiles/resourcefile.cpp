@@ -246,7 +246,7 @@ FResourceFile *FResourceFile::OpenResourceFile(const char *filename, FileReader
 	{
 		try
 		{
-			file = new FileReader(filename);
+			file = new MappedFileReader(filename);
 		}
 		catch (CRecoverableError &)
 		{
@@ -594,9 +594,8 @@ int FUncompressedLump::FillCache()
 		return -1;
 	}
 
-	Owner->Reader->Seek(Position, SEEK_SET);
 	Cache = new char[LumpSize];
-	Owner->Reader->Read(Cache, LumpSize);
+	Owner->Reader->ReadAt(Cache, LumpSize, Position);
 	RefCount = 1;
 	return 1;
 }
@@ -59,6 +59,10 @@ struct FResourceLump
 	void *CacheLump();
 	int ReleaseCache();
 
+	// True if FillCache doesn't touch the shared archive reader's position,
+	// so that different lumps may be cached from several threads at once.
+	virtual bool CanCacheConcurrently() const { return false; }
+
 protected:
 	virtual int FillCache() = 0;
 
@@ -106,6 +110,7 @@ struct FUncompressedLump : public FResourceLump
 	virtual FileReader *GetReader();
 	virtual int FillCache();
 	virtual int GetFileOffset() { return Position; }
+	virtual bool CanCacheConcurrently() const { return true; }
 
 };
 
@@ -15,6 +15,7 @@
 //#include "r_swrenderer.h"
 #include "thingdef/thingdef.h"
 #include "wl_main.h"
+#include "wl_draw.h"
 #include "version.h"
 
 #include <SDL.h>
@@ -772,6 +773,7 @@ int SDLFB::GetPageCount ()
 
 bool SDLFB::Lock (bool buffered)
 {
+	R_SyncRefresh ();
 	return DSimpleCanvas::Lock ();
 }
 
@@ -40,7 +40,10 @@
 #include "w_wad.h"
 #include "scanner.h"
 #include "zdoomsupport.h"
+#include "m_workers.h"
 #include <SDL_mixer.h>
+#include <atomic>
+#include <vector>
 
 
 // TFuncDeleter can't be used here since Mix_FreeChunk has various attributes
@@ -62,6 +65,11 @@ SoundIndex::SoundIndex(const char* logical)
 	index = SoundInfo.FindSound(logical);
 }
 
+SoundIndex::SoundIndex(FName logical)
+{
+	index = SoundInfo.FindSound(logical);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //
 // Sound Data
@@ -201,6 +209,11 @@ void SoundInformation::CreateHashTable()
 		}
 
 		tid->index = i;
+
+		const unsigned int name = FName(data.logicalName);
+		if(name >= soundsByName.Size())
+			soundsByName.Resize(name+1);
+		soundsByName[name] = data.index;
 	}
 }
 
@@ -220,6 +233,14 @@ SoundIndex SoundInformation::FindSound(const char* logical) const
 	return SoundIndex(index->index);
 }
 
+SoundIndex SoundInformation::FindSound(FName logical) const
+{
+	const unsigned int name = logical;
+	if(name >= soundsByName.Size())
+		return SoundIndex();
+	return soundsByName[name];
+}
+
 int SoundInformation::GetMusicLumpNum(FString song) const
 {
 	const int lump = Wads.CheckNumForName(song, ns_music);
@@ -232,6 +253,30 @@ int SoundInformation::GetMusicLumpNum(FString song) const
 	return lump;
 }
 
+// Digitized sounds are converted to the mixer's format on the worker pool
+// while the rest of startup carries on. The lumps are read before the tasks
+// are posted, so they only ever touch their own data and SDL_mixer.
+static struct SoundDecoder
+{
+	Workers::Group tasks;
+	std::vector<unsigned int> sounds;
+	std::vector<FMemLump> lumps;
+	std::vector<Mix_Chunk *> chunks;
+	std::atomic<size_t> next;
+} Decoder;
+
+static void DecodeSounds()
+{
+	size_t i;
+	while((i = Decoder.next++) < Decoder.sounds.size())
+		Decoder.chunks[i] = SD_DecodeSound(Decoder.lumps[i].GetMem(), (int)Decoder.lumps[i].GetSize());
+}
+
+static void FinishSoundLoading()
+{
+	SoundInfo.FinishLoading();
+}
+
 void SoundInformation::Init()
 {
 	printf("S_Init: Reading SNDINFO defintions.\n");
@@ -244,6 +289,48 @@ void SoundInformation::Init()
 	}
 
 	CreateHashTable();
+
+	// Only the last definition of each sound is decoded.
+	TArray<int> lumps;
+	for(unsigned int i = 0;i < sounds.Size();++i)
+	{
+		if(!sounds[i].isAlias && sounds[i].lump[0] != -1)
+		{
+			Decoder.sounds.push_back(i);
+			lumps.Push(sounds[i].lump[0]);
+		}
+	}
+	if(Decoder.sounds.empty())
+		return;
+
+	Wads.CacheLumps(lumps);
+	for(unsigned int i = 0;i < lumps.Size();++i)
+		Decoder.lumps.push_back(Wads.ReadLump(lumps[i]));
+	Wads.ReleaseLumps(lumps);
+
+	Decoder.chunks.assign(Decoder.sounds.size(), NULL);
+	Decoder.next = 0;
+	const size_t numTasks = MIN<size_t>(Decoder.sounds.size(), MAX(Workers::NumThreads(), 1u));
+	for(size_t i = 0;i < numTasks;++i)
+		Decoder.tasks.Run(DecodeSounds);
+	atterm(FinishSoundLoading);
+}
+
+// Waits for the tasks posted by Init and hands the converted sounds over.
+// Must be called before any digitized sound is played.
+void SoundInformation::FinishLoading()
+{
+	if(Decoder.sounds.empty())
+		return;
+
+	Decoder.tasks.Wait();
+
+	for(size_t i = 0;i < Decoder.sounds.size();++i)
+		sounds[Decoder.sounds[i]].digitalData.Reset(Decoder.chunks[i]);
+
+	Decoder.sounds.clear();
+	Decoder.lumps.clear();
+	Decoder.chunks.clear();
 }
 
 void SoundInformation::ParseSoundInformation(int lumpNum)
@@ -363,11 +450,7 @@ void SoundInformation::ParseSoundInformation(int lumpNum)
 					continue;
 
 				idx.lump[i] = sndLump;
-				if(i == 0)
-				{
-					idx.digitalData.Reset(SD_PrepareSound(sndLump));
-				}
-				else
+				if(i != 0)
 				{
 					unsigned int length = Wads.LumpLength(sndLump);
 					TUniquePtr<byte[]> &data = i == 1 ? idx.adlibData : idx.speakerData;
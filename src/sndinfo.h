@@ -49,8 +49,9 @@ struct Mix_ChunkDeleter;
 class SoundIndex
 {
 	public:
-		SoundIndex(int index = 0) : index(index) {}
+		explicit SoundIndex(int index = 0) : index(index) {}
 		SoundIndex(const char* logical);
+		SoundIndex(FName logical);
 
 		operator int() const { return index; }
 
@@ -120,7 +121,9 @@ class SoundInformation
 		~SoundInformation();
 
 		SoundIndex		FindSound(const char* logical) const;
+		SoundIndex		FindSound(FName logical) const;
 		void			Init();
+		void			FinishLoading();
 		const SoundData	&operator[] (const char* logical) const { return operator[](FindSound(logical)); }
 		const SoundData	&operator[] (const SoundIndex &index) const;
 		uint32_t		GetLastPlayTick(const SoundData &sound) const { return lastPlayTicks[sound.index]; }
@@ -146,6 +149,9 @@ class SoundInformation
 
 		struct HashIndex;
 		HashIndex*	hashTable;
+		// Sound indexes keyed by name index so that names resolved at
+		// DECORATE time don't need to be hashed again when played.
+		TArray<SoundIndex>	soundsByName;
 };
 extern SoundInformation	SoundInfo;
 
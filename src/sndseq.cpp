@@ -248,8 +248,8 @@ SndSeqPlayer::~SndSeqPlayer()
 }
 
 // SD_SoundPlaying() seems to intentionally be for adlib/pc speaker only. At
-// least it has been like that since the beginning of ECWolf.
-extern FString SoundPlaying;
+// least it has been like that since the beginning of ECWolf, so check
+// SoundPlaying directly.
 void SndSeqPlayer::Tick()
 {
 	if(!Playing || (Delay != 0 && --Delay > 0))
@@ -257,7 +257,7 @@ void SndSeqPlayer::Tick()
 
 	if(WaitForDone)
 	{
-		if(SoundPlaying.IsNotEmpty())
+		if(SoundPlaying != 0)
 			return;
 		else
 			WaitForDone = false;
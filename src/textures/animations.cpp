@@ -581,6 +581,7 @@ void FTextureManager::ParseWarp(Scanner &sc)
 			else warper = new FWarpTexture (warper);
 
 			ReplaceTexture (picnum, warper, false);
+			mWarpTextures.Push (static_cast<FWarpTexture*>(warper));
 		}
 
 		if (sc.CheckToken(TK_FloatConst))
@@ -859,12 +860,14 @@ void FTextureManager::UpdateAnimations (DWORD mstime)
 	for (unsigned int j = 0; j < mAnimations.Size(); ++j)
 	{
 		FAnimDef *anim = mAnimations[j];
+		bool advanced = false;
 
 		// If this is the first time through R_UpdateAnimations, just
 		// initialize the anim's switch time without actually animating.
 		if (anim->SwitchTime == 0)
 		{
 			anim->SetSwitchTime (mstime);
+			advanced = true;
 		}
 		else while (anim->SwitchTime <= mstime)
 		{ // Multiple frames may have passed since the last time calling
@@ -906,6 +909,14 @@ void FTextureManager::UpdateAnimations (DWORD mstime)
 				break;
 			}
 			anim->SetSwitchTime (mstime);
+			++AnimationGeneration;
+			advanced = true;
+		}
+
+		// The translations only need to change along with the frame
+		if (!advanced)
+		{
+			continue;
 		}
 
 		if (anim->AnimType == FAnimDef::ANIM_DiscreteFrames)
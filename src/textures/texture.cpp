@@ -41,6 +41,7 @@
 #include "r_data/r_translate.h"
 #include "bitmap.h"
 #include "colormatcher.h"
+#include "v_palette.h"
 #include "textures.h"
 
 #define countof(x) (sizeof(x)/sizeof(x[0]))
@@ -232,6 +233,103 @@ void FTexture::CalcBitSize ()
 	HeightBits = i;
 }
 
+//==========================================================================
+//
+// FTexture :: GetMipLevels
+//
+//==========================================================================
+
+int FTexture::GetMipLevels ()
+{
+	if (bMasked || bWarped || bHasCanvas ||
+		Width != (1 << WidthBits) || Height != (1 << HeightBits))
+	{
+		return 0;
+	}
+	return MIN<int>(WidthBits, HeightBits);
+}
+
+//==========================================================================
+//
+// FTexture :: GetMipmap
+//
+// The levels are built together on first use. Distant walls and flats
+// sample these instead of skipping across the full size image, which both
+// cuts the shimmer and keeps the texels being read in cache.
+//
+//==========================================================================
+
+const BYTE *FTexture::GetMipmap (int level)
+{
+	if (level <= 0)
+		return GetPixels ();
+
+	if (MipOffsets.Size() == 0)
+	{
+		MakeMipmaps ();
+		if (MipOffsets.Size() == 0)
+			return GetPixels ();
+	}
+	return &Mipmaps[MipOffsets[MIN<int>(level, MipOffsets.Size()-1)]];
+}
+
+void FTexture::FreeMipmaps ()
+{
+	Mipmaps.Clear ();
+	MipOffsets.Clear ();
+}
+
+//==========================================================================
+//
+// FTexture :: MakeMipmaps
+//
+// Each level is a 2x2 box filter of the one above it, averaged in RGB and
+// matched back to the palette.
+//
+//==========================================================================
+
+void FTexture::MakeMipmaps ()
+{
+	const BYTE *src = GetPixels ();
+	const int levels = GetMipLevels ();
+	if (levels == 0)
+		return;
+
+	unsigned int size = 0;
+	MipOffsets.Resize (levels+1);
+	MipOffsets[0] = 0;
+	for (int i = 1; i <= levels; ++i)
+	{
+		MipOffsets[i] = size;
+		size += (Width >> i) * (Height >> i);
+	}
+	Mipmaps.Resize (size);
+
+	int w = Width, h = Height;
+	for (int i = 1; i <= levels; ++i)
+	{
+		BYTE *dest = &Mipmaps[MipOffsets[i]];
+		for (int x = 0; x < w; x += 2)
+		{
+			const BYTE *col = src + x*h;
+			for (int y = 0; y < h; y += 2)
+			{
+				const PalEntry &a = GPalette.BaseColors[col[y]];
+				const PalEntry &b = GPalette.BaseColors[col[y+1]];
+				const PalEntry &c = GPalette.BaseColors[col[h+y]];
+				const PalEntry &d = GPalette.BaseColors[col[h+y+1]];
+				*dest++ = ColorMatcher.Pick (
+					(a.r + b.r + c.r + d.r + 2) >> 2,
+					(a.g + b.g + c.g + d.g + 2) >> 2,
+					(a.b + b.b + c.b + d.b + 2) >> 2);
+			}
+		}
+		src = &Mipmaps[MipOffsets[i]];
+		w >>= 1;
+		h >>= 1;
+	}
+}
+
 void FTexture::HackHack (int newheight)
 {
 }
@@ -52,6 +52,7 @@
 #include "g_mapinfo.h"
 #include "gamemap.h"
 #include "farchive.h"
+#include "c_cvars.h"
 
 #define TEXTCOLOR_ORANGE
 
@@ -72,6 +73,7 @@ FTextureManager TexMan;
 FTextureManager::FTextureManager ()
 {
 	memset (HashFirst, -1, sizeof(HashFirst));
+	AnimationGeneration = 0;
 
 }
 
@@ -113,6 +115,7 @@ void FTextureManager::DeleteAll()
 		}
 	}
 	mAnimations.Clear();
+	mWarpTextures.Clear();
 
 	for (unsigned i = 0; i < mSwitchDefs.Size(); i++)
 	{
@@ -377,6 +380,7 @@ void FTextureManager::InvalidatePalette ()
 	for (unsigned int i = 0; i < Textures.Size(); ++i)
 	{
 		Textures[i].Texture->InvalidatePalette ();
+		Textures[i].Texture->FreeMipmaps ();
 	}
 }
 
@@ -466,6 +470,10 @@ void FTextureManager::ReplaceTexture (FTextureID picnum, FTexture *newtexture, b
 		return;
 
 	FTexture *oldtexture = Textures[index].Texture;
+	if (oldtexture->bWarped)
+	{
+		mWarpTextures.Delete (mWarpTextures.Find (static_cast<FWarpTexture*>(oldtexture)));
+	}
 
 	newtexture->Name = oldtexture->Name;
 	newtexture->UseType = oldtexture->UseType;
@@ -1256,6 +1264,20 @@ void FTextureManager::PrecacheLevel (void)
 	memset (hitlist, 0, cnt);
 
 	map->GetHitlist(hitlist+1);
+
+	// Read and decompress the source lumps up front on all cores
+	TArray<int> lumps;
+	for (int i = cnt - 1; i > 0; i--)
+	{
+		if(hitlist[i])
+		{
+			int lump = ByIndex(i-1)->GetSourceLump();
+			if(lump >= 0)
+				lumps.Push(lump);
+		}
+	}
+	Wads.CacheLumps(lumps);
+
 	unsigned int numcached = 0;
 	for (int i = cnt - 1; i > 0; i--)
 	{
@@ -1264,16 +1286,21 @@ void FTextureManager::PrecacheLevel (void)
 		{
 			const FTexture::Span *spanp;
 			tex->GetColumn(0, &spanp);
+			if(vid_mipmaps && tex->UseType != FTexture::TEX_Sprite)
+				tex->GetMipmap(1);
 			++numcached;
 		}
 		else if(hitlist[i])
 		{
 			++numcached;
 			tex->GetPixels();
+			if(vid_mipmaps && (hitlist[i] & 2))
+				tex->GetMipmap(1);
 		}
 		else
 			tex->Unload();
 	}
+	Wads.ReleaseLumps(lumps);
 
 #if 0
 	// Debug code - Show number of textures precached
@@ -207,6 +207,15 @@ public:
 
 	// Returns the whole texture, stored in column-major order
 	virtual const BYTE *GetPixels () = 0;
+
+	// Returns the texture box filtered down by 1<<level on each side, stored
+	// in column-major order like GetPixels. Level 0 is GetPixels itself.
+	const BYTE *GetMipmap (int level);
+
+	// Number of levels GetMipmap can return below the full size image. Masked,
+	// warped, canvas and non-power-of-two textures have none.
+	int GetMipLevels ();
+	void FreeMipmaps ();
 	
 	virtual int CopyTrueColorPixels(FBitmap *bmp, int x, int y, int rotate=0, FCopyInfo *inf = NULL);
 	int CopyTrueColorTranslated(FBitmap *bmp, int x, int y, int rotate, FRemapTable *remap, FCopyInfo *inf = NULL);
@@ -281,6 +290,8 @@ public:
 protected:
 	WORD Width, Height, WidthMask;
 	static BYTE GrayMap[256];
+	TArray<BYTE> Mipmaps;
+	TArray<unsigned int> MipOffsets;
 	//FNativeTexture *Native;
 
 	FTexture (const char *name = NULL, int lumpnum = -1);
@@ -288,6 +299,7 @@ protected:
 	Span **CreateSpans (const BYTE *pixels) const;
 	void FreeSpans (Span **spans) const;
 	void CalcBitSize ();
+	void MakeMipmaps ();
 	void CopyInfo(FTexture *other)
 	{
 		CopySize(other);
@@ -408,6 +420,11 @@ public:
 	int ReadTexture (FArchive &arc);
 
 	void UpdateAnimations (DWORD mstime);
+	// Regenerates the warp textures seen last frame ahead of drawing.
+	void UpdateWarpTextures ();
+	// Incremented whenever an animation advances a frame so that cached
+	// renderings can tell if they are stale.
+	unsigned int GetAnimationGeneration () const { return AnimationGeneration; }
 	int GuesstimateNumTextures ();
 
 	FSwitchDef *FindSwitch (FTextureID texture);
@@ -472,6 +489,8 @@ private:
 	TMap<int,int> PalettedVersions;		// maps from normal -> paletted version
 
 	TArray<FAnimDef *> mAnimations;
+	unsigned int AnimationGeneration;
+	TArray<class FWarpTexture *> mWarpTextures;
 	TArray<FSwitchDef *> mSwitchDefs;
 	TArray<FDoorAnimation> mAnimatedDoors;
 	TArray<BYTE *> BuildTileFiles;
@@ -519,7 +538,16 @@ public:
 	void SetSpeed(float fac) { Speed = fac; }
 	FTexture *GetRedirect(bool wantwarped);
 
+	// Warp animation time in ms, quantized to vid_warprate.
+	static DWORD GetWarpTime ();
+
+	bool NeedsUpdate (DWORD time) const { return Pixels == NULL || time != GenTime; }
+	// Loads the source so that Update can safely run on a worker thread.
+	void LoadSource () { SourcePic->GetPixels (); }
+	void Update (DWORD time) { if (NeedsUpdate (time)) MakeTexture (time); }
+
 	DWORD GenTime;
+	bool Referenced;	// Drawn since the last UpdateWarpTextures
 protected:
 	FTexture *SourcePic;
 	BYTE *Pixels;
@@ -34,7 +34,9 @@
 */
 
 #include "wl_def.h"
+#include "c_cvars.h"
 #include "files.h"
+#include "m_workers.h"
 //#include "r_main.h"
 #include "templates.h"
 #include "textures.h"
@@ -46,7 +48,7 @@
 
 
 FWarpTexture::FWarpTexture (FTexture *source)
-: GenTime (0), SourcePic (source), Pixels (0), Spans (0), Speed (1.f)
+: GenTime (0), Referenced (false), SourcePic (source), Pixels (0), Spans (0), Speed (1.f)
 {
 	CopyInfo(source);
 	bWarped = 1;
@@ -78,15 +80,29 @@ void FWarpTexture::Unload ()
 	SourcePic->Unload ();
 }
 
+DWORD FWarpTexture::GetWarpTime ()
+{
+	DWORD time = gamestate.TimeCount*14;
+	if (vid_warprate)
+	{
+		const DWORD period = MAX<DWORD>(1000/vid_warprate, 1);
+		time -= time % period;
+	}
+	return time;
+}
+
 bool FWarpTexture::CheckModified ()
 {
-	return (unsigned)gamestate.TimeCount != GenTime;
+	return GetWarpTime() != GenTime;
 }
 
+// Both accessors use the same clock so a texture used for walls and flats
+// in the same frame is only generated once.
 const BYTE *FWarpTexture::GetPixels ()
 {
-	DWORD time = gamestate.TimeCount;
+	DWORD time = GetWarpTime();
 
+	Referenced = true;
 	if (Pixels == NULL || time != GenTime)
 	{
 		MakeTexture (time);
@@ -96,8 +112,9 @@ const BYTE *FWarpTexture::GetPixels ()
 
 const BYTE *FWarpTexture::GetColumn (unsigned int column, const Span **spans_out)
 {
-	DWORD time = gamestate.TimeCount*14;
+	DWORD time = GetWarpTime();
 
+	Referenced = true;
 	if (Pixels == NULL || time != GenTime)
 	{
 		MakeTexture (time);
@@ -153,24 +170,36 @@ void FWarpTexture::MakeTexture (DWORD time)
 		ybits--;
 	}
 
+	// Horizontal shift per row. Filled a column at a time so the stores are
+	// sequential.
+	int *rowshift = (int *)alloca (ysize * sizeof(int));
 	DWORD timebase = DWORD(time * Speed * 32 / 28);
-	for (y = ysize-1; y >= 0; y--)
+	for (y = 0; y < ysize; y++)
+		rowshift[y] = finesine[(timebase+y*128)&FINEMASK]>>13;
+	for (x = 0; x < xsize; x++)
 	{
-		int xt, xf = (finesine[(timebase+y*128)&FINEMASK]>>13) & xmask;
-		const BYTE *source = otherpix + y;
-		BYTE *dest = Pixels + y;
-		for (xt = xsize; xt; xt--, xf = (xf+1)&xmask, dest += ysize)
-			*dest = source[xf << ybits];
+		BYTE *dest = Pixels + x*ysize;
+		for (y = 0; y < ysize; y++)
+			dest[y] = otherpix[(((rowshift[y] + x) & xmask) << ybits) + y];
 	}
 	timebase = DWORD(time * Speed * 23 / 28);
 	for (x = xsize-1; x >= 0; x--)
 	{
-		int yt, yf = (finesine[(time+(x+17)*128)&FINEMASK]>>13) & ymask;
-		const BYTE *source = Pixels + (x << ybits);
-		BYTE *dest = buffer;
-		for (yt = ysize; yt; yt--, yf = (yf+1)&ymask)
-			*dest++ = source[yf];
-		memcpy (Pixels+(x<<ybits), buffer, ysize);
+		int yf = (finesine[(time+(x+17)*128)&FINEMASK]>>13) & ymask;
+		BYTE *column = Pixels + (x << ybits);
+		if (ymask + 1 == ysize)
+		{
+			// Vertical shift is a rotation of the column
+			memcpy (buffer, column + yf, ysize - yf);
+			memcpy (buffer + ysize - yf, column, yf);
+		}
+		else
+		{
+			BYTE *dest = buffer;
+			for (int yt = ysize; yt; yt--, yf = (yf+1)&ymask)
+				*dest++ = column[yf];
+		}
+		memcpy (column, buffer, ysize);
 	}
 }
 
@@ -209,23 +238,73 @@ void FWarp2Texture::MakeTexture (DWORD time)
 		ybits--;
 	}
 
+	// Each offset is a sum of a term depending only on the row and one
+	// depending only on the column, so the sine lookups can be done once per
+	// row and column instead of per texel.
+	int *rowx = (int *)alloca (ysize * sizeof(int));
+	int *rowy = (int *)alloca (ysize * sizeof(int));
 	DWORD timebase = DWORD(time * Speed * 40 / 28);
+	for (y = 0; y < ysize; ++y)
+	{
+		rowx[y] = (finesine[(y*128 + timebase*5 + 900) & FINEMASK]*2)>>FRACBITS;
+		rowy[y] = y + ((finesine[(y*128 + timebase*3 + 700) & FINEMASK]*2)>>FRACBITS);
+	}
 	for (x = 0; x < xsize; ++x)
 	{
+		const int colx = x + 128 + ((finesine[(x*256 + timebase*4 + 300) & FINEMASK]*2)>>FRACBITS);
+		const int coly = 128 + ((finesine[(x*256 + timebase*4 + 1200) & FINEMASK]*2)>>FRACBITS);
 		BYTE *dest = Pixels + (x << ybits);
 		for (y = 0; y < ysize; ++y)
 		{
-			int xt = (x + 128
-				+ ((finesine[(y*128 + timebase*5 + 900) & FINEMASK]*2)>>FRACBITS)
-				+ ((finesine[(x*256 + timebase*4 + 300) & FINEMASK]*2)>>FRACBITS)) & xmask;
-			int yt = (y + 128
-				+ ((finesine[(y*128 + timebase*3 + 700) & FINEMASK]*2)>>FRACBITS)
-				+ ((finesine[(x*256 + timebase*4 + 1200) & FINEMASK]*2)>>FRACBITS)) & ymask;
-			*dest++ = otherpix[(xt << ybits) + yt];
+			int xt = (colx + rowx[y]) & xmask;
+			int yt = (coly + rowy[y]) & ymask;
+			dest[y] = otherpix[(xt << ybits) + yt];
 		}
 	}
 }
 
+//==========================================================================
+//
+// FTextureManager :: UpdateWarpTextures
+//
+// Warps are regenerated when touched with a new time, which would happen
+// serially in the middle of drawing walls. Instead regenerate anything that
+// was drawn last frame up front, spreading the textures over threads. Warps
+// coming into view still take the lazy path.
+//
+//==========================================================================
+
+void FTextureManager::UpdateWarpTextures ()
+{
+	static TArray<FWarpTexture *> stale;
+	const DWORD time = FWarpTexture::GetWarpTime();
+
+	stale.Clear();
+	for (unsigned int i = 0; i < mWarpTextures.Size(); ++i)
+	{
+		FWarpTexture *warp = mWarpTextures[i];
+		if (warp->Referenced && warp->NeedsUpdate(time))
+		{
+			// Loading the source may need to touch the lump cache
+			warp->LoadSource();
+			stale.Push(warp);
+		}
+		warp->Referenced = false;
+	}
+
+	if (stale.Size() <= 1)
+	{
+		if (stale.Size() == 1)
+			stale[0]->Update(time);
+		return;
+	}
+
+	Workers::ParallelFor(stale.Size(), [time](size_t i)
+	{
+		stale[i]->Update(time);
+	});
+}
+
 //==========================================================================
 //
 // FMultiPatchTexture :: TexPart :: TexPart
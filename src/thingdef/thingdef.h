@@ -79,7 +79,8 @@ class CallArguments
 					VAL_INTEGER,
 					VAL_DOUBLE,
 					VAL_STRING,
-					VAL_STATE
+					VAL_STATE,
+					VAL_SOUND
 				} useType;
 				bool isExpression;
 
@@ -156,6 +157,8 @@ typedef TArray<ActionInfo *> ActionTable;
 	fixed name = static_cast<fixed>(args[num].val.d*FRACUNIT)
 #define ACTION_PARAM_STRING(name, num) \
 	FString name = args[num].str
+#define ACTION_PARAM_SOUND(name, num) \
+	SoundIndex name = SoundIndex(FName(ENamedName(args[num].val.i)))
 #define ACTION_PARAM_STATE(name, num, def) \
 	const Frame *name = args[num].label.Resolve(stateOwner, caller, def)
 
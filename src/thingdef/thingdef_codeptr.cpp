@@ -670,10 +670,10 @@ ACTION_FUNCTION(A_MeleeAttack)
 {
 	ACTION_PARAM_INT(damage, 0);
 	ACTION_PARAM_DOUBLE(accuracy, 1);
-	ACTION_PARAM_STRING(hitsound, 2);
-	ACTION_PARAM_STRING(misssound, 3);
+	ACTION_PARAM_SOUND(hitsound, 2);
+	ACTION_PARAM_SOUND(misssound, 3);
 
-	if(misssound.Compare("*") == 0)
+	if(args[3].str.Compare("*") == 0)
 		misssound = hitsound;
 
 	A_Face(self, self->target);
@@ -684,12 +684,12 @@ ACTION_FUNCTION(A_MeleeAttack)
 			const ClassDef *meleeDamageClass =
 				ClassDef::FindClassTentative("MeleeDamage", NATIVE_CLASS(Damage));
 			DamageActor(self->target, self, damage, meleeDamageClass);
-			if(!hitsound.IsEmpty())
+			if(hitsound)
 				PlaySoundLocActor(hitsound, self);
 			return true;
 		}
 	}
-	if(!misssound.IsEmpty())
+	if(misssound)
 		PlaySoundLocActor(misssound, self);
 	return false;
 }
@@ -776,7 +776,7 @@ ACTION_FUNCTION(A_PlaySound)
 		CHAN_BODY = 5,
 	};
 
-	ACTION_PARAM_STRING(sound, 0);
+	ACTION_PARAM_SOUND(sound, 0);
 	ACTION_PARAM_INT(channel, 1);
 	ACTION_PARAM_DOUBLE(volume, 2);
 	ACTION_PARAM_BOOL(looping, 3);
@@ -239,6 +239,13 @@ void FDecorateParser::ParseActorAction()
 						defVal.label = StateLabel(sc->str, newClass);
 					}
 				}
+				else if (type == TypeHierarchy::staticTypes.GetType(TypeHierarchy::SOUND))
+				{
+					sc.MustGetToken(TK_StringConst);
+					defVal.useType = CallArguments::Value::VAL_SOUND;
+					defVal.str = sc->str;
+					defVal.val.i = FName(sc->str);
+				}
 				else
 				{
 					sc.MustGetToken(TK_StringConst);
@@ -639,6 +646,15 @@ void FDecorateParser::ParseActorStateAction(StateDefinition &thisState, int func
 							val.label = StateLabel(sc->str, newClass);
 						}
 					}
+					else if(argType == TypeHierarchy::staticTypes.GetType(TypeHierarchy::SOUND))
+					{
+						// SNDINFO hasn't been read yet so keep the name, which
+						// can be turned into a sound index without rehashing.
+						sc.MustGetToken(TK_StringConst);
+						val.useType = CallArguments::Value::VAL_SOUND;
+						val.str = sc->str;
+						val.val.i = FName(sc->str);
+					}
 					else
 					{
 						sc.MustGetToken(TK_StringConst);
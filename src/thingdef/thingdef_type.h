@@ -89,6 +89,7 @@ class TypeHierarchy
 			STATE,
 			ANGLE_T,
 			AUTO,
+			SOUND,
 
 			NUM_TYPES
 		};
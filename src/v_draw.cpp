@@ -63,6 +63,7 @@
 #include "r_data/colormaps.h"
 #include "c_cvars.h"
 #include "wl_main.h"
+#include "wl_draw.h"
 
 static inline SDWORD DivScale32(const SQWORD a, const SDWORD b)
 {
@@ -128,8 +129,16 @@ void STACK_ARGS DCanvas::DrawTexture (FTexture *img, double x, double y, int tag
 	DrawTextureV(img, x, y, tags_first, tags);
 }
 
+void DCanvas::SyncRefresh () const
+{
+	if (this == screen)
+		R_SyncRefresh ();
+}
+
 void STACK_ARGS DCanvas::DrawTextureV(FTexture *img, double x, double y, uint32 tag, va_list tags)
 {
+	SyncRefresh ();
+
 #ifndef NO_SWRENDER
 	FTexture::Span unmaskedSpan[2];
 	const FTexture::Span **spanptr, *spans;
@@ -916,6 +925,8 @@ void DCanvas::PUTTRANSDOT (int xx, int yy, int basecolor, int level)
 void DCanvas::DrawLine(int x0, int y0, int x1, int y1, int palColor, uint32 realcolor)
 //void DrawTransWuLine (int x0, int y0, int x1, int y1, BYTE palColor)
 {
+	SyncRefresh ();
+
 	const int WeightingScale = 0;
 	const int WEIGHTBITS = 6;
 	const int WEIGHTSHIFT = 16-WEIGHTBITS;
@@ -1075,6 +1086,8 @@ void DCanvas::DrawLine(int x0, int y0, int x1, int y1, int palColor, uint32 real
 
 void DCanvas::DrawPixel(int x, int y, int palColor, uint32 realcolor)
 {
+	SyncRefresh ();
+
 	if (palColor < 0)
 	{
 		palColor = PalFromRGB(realcolor);
@@ -1096,6 +1109,8 @@ void DCanvas::Clear (int left, int top, int right, int bottom, int palcolor, uin
 	int x, y;
 	BYTE *dest;
 
+	SyncRefresh ();
+
 	if (left == right || top == bottom)
 	{
 		return;
@@ -1152,6 +1167,8 @@ void DCanvas::FillSimplePoly(FTexture *tex, FVector2 *points, int npoints,
 	double originx, double originy, double scalex, double scaley, angle_t rotation,
 	FDynamicColormap *colormap, int lightlevel, int palcolor, uint32 rgbcolor)
 {
+	SyncRefresh ();
+
 #ifndef NO_SWRENDER
 	// Use an equation similar to player sprites to determine shade
 	fixed_t shade = LIGHT2SHADE(lightlevel) - 12*FRACUNIT;
@@ -1326,6 +1343,8 @@ void DCanvas::DrawBlock (int x, int y, int _width, int _height, const BYTE *src)
 	int destpitch;
 	BYTE *dest;
 
+	SyncRefresh ();
+
 	if (ClipBox (x, y, _width, _height, src, srcpitch))
 	{
 		return;		// Nothing to draw
@@ -1350,6 +1369,8 @@ void DCanvas::GetBlock (int x, int y, int _width, int _height, BYTE *dest) const
 {
 	const BYTE *src;
 
+	SyncRefresh ();
+
 #ifdef RANGECHECK 
 	if (x<0
 		||x+_width > Width
@@ -191,6 +191,8 @@ void DCanvas::Dim (PalEntry color, float damount, int x1, int y1, int w, int h)
 	if (damount == 0.f)
 		return;
 
+	SyncRefresh ();
+
 	DWORD *bg2rgb;
 	DWORD fg;
 	int gap;
@@ -41,6 +41,8 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <string.h>
+#include <algorithm>
+#include <vector>
 
 #include "w_wad.h"
 #include "w_zip.h"
@@ -49,6 +51,7 @@
 #include "resourcefiles/resourcefile.h"
 #include "zdoomsupport.h"
 #include "filesys.h"
+#include "m_workers.h"
 
 // Work around missing defines for ECWolf
 #ifndef PATH_MAX
@@ -240,7 +243,7 @@ void FWadCollection::AddFile (const char *filename, FileReader *wadinfo)
 		{
 			try
 			{
-				wadinfo = new FileReader(filename);
+				wadinfo = new MappedFileReader(filename);
 			}
 			catch (CRecoverableError &err)
 			{ // Didn't find file
@@ -988,6 +991,94 @@ FMemLump FWadCollection::ReadLump (int lump)
 	return FMemLump(FString(ELumpNum(lump)));
 }
 
+//==========================================================================
+//
+// CacheLumps
+//
+// Makes sure all of the given lumps are in the cache, with each distinct
+// lump gaining one reference as with FResourceLump::CacheLump. Lumps which
+// don't depend on their archive's file position are read and decompressed
+// on worker threads.
+//
+//==========================================================================
+
+void FWadCollection::CacheLumps (const TArray<int> &lumps)
+{
+	if (lumps.Size() == 0)
+		return;
+
+	std::vector<int> sorted(&lumps[0], &lumps[0] + lumps.Size());
+	std::sort(sorted.begin(), sorted.end());
+	sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+	std::vector<FResourceLump *> jobs;
+	for (size_t i = 0; i < sorted.size(); ++i)
+	{
+		if ((unsigned)sorted[i] >= NumLumps)
+			continue;
+
+		FResourceLump *lump = LumpInfo[sorted[i]].lump;
+		if (lump->Cache == NULL && lump->LumpSize > 0 && lump->CanCacheConcurrently())
+			jobs.push_back(lump);
+		else
+			lump->CacheLump();
+	}
+
+	if (jobs.empty())
+		return;
+
+	std::vector<char> failed(jobs.size(), false);
+	Workers::ParallelFor(jobs.size(), [&](size_t i)
+	{
+		try
+		{
+			jobs[i]->CacheLump();
+		}
+		catch (...)
+		{
+			failed[i] = true;
+		}
+	});
+
+	// Redo anything that errored on this thread so the error is reported
+	// the usual way.
+	for (size_t i = 0; i < jobs.size(); ++i)
+	{
+		if (failed[i])
+		{
+			if (jobs[i]->RefCount >= 0)
+				delete[] jobs[i]->Cache;
+			jobs[i]->Cache = NULL;
+			jobs[i]->RefCount = 0;
+			jobs[i]->CacheLump();
+		}
+	}
+}
+
+//==========================================================================
+//
+// ReleaseLumps
+//
+// Releases the references taken by CacheLumps for the same list of lumps.
+//
+//==========================================================================
+
+void FWadCollection::ReleaseLumps (const TArray<int> &lumps)
+{
+	if (lumps.Size() == 0)
+		return;
+
+	std::vector<int> sorted(&lumps[0], &lumps[0] + lumps.Size());
+	std::sort(sorted.begin(), sorted.end());
+	sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+	for (size_t i = 0; i < sorted.size(); ++i)
+	{
+		if ((unsigned)sorted[i] < NumLumps)
+			LumpInfo[sorted[i]].lump->ReleaseCache();
+	}
+}
+
 //==========================================================================
 //
 // OpenLumpNum
@@ -1197,7 +1288,8 @@ FWadLump::FWadLump(FResourceLump *lump, bool alwayscache)
 {
 	FileReader *f = lump->GetReader();
 
-	if (f != NULL && f->GetFile() != NULL && !alwayscache)
+	// Mapped files are served from the lump cache which points into the mapping
+	if (f != NULL && f->GetFile() != NULL && f->GetBuffer() == NULL && !alwayscache)
 	{
 		// Uncompressed lump in a file
 		File = f->GetFile();
@@ -1268,6 +1360,19 @@ long FWadLump::Read (void *buffer, long len)
 	return numread;
 }
 
+long FWadLump::ReadAt (void *buffer, long len, long offset)
+{
+	if (Lump != NULL)
+	{
+		if (offset < 0 || offset > Length) return 0;
+		if (len > Length - offset) len = Length - offset;
+		if (len < 0) len = 0;
+		memcpy(buffer, Lump->Cache + offset, len);
+		return len;
+	}
+	return FileReader::ReadAt(buffer, len, offset);
+}
+
 char *FWadLump::Gets(char *strbuf, int len)
 {
 	if (Lump != NULL)
@@ -111,6 +111,7 @@ public:
 
 	long Seek (long offset, int origin);
 	long Read (void *buffer, long len);
+	long ReadAt (void *buffer, long len, long offset);
 	char *Gets(char *strbuf, int len);
 
 private:
@@ -183,6 +184,8 @@ public:
 
 	void ReadLump (int lump, void *dest);
 	FMemLump ReadLump (int lump);
+	void CacheLumps (const TArray<int> &lumps);	// Caches (and decompresses) lumps on several threads
+	void ReleaseLumps (const TArray<int> &lumps);	// Drops the references taken by CacheLumps
 	FMemLump ReadLump (const char *name) { return ReadLump (GetNumForName (name)); }
 
 	FWadLump OpenLumpNum (int lump);
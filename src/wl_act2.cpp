@@ -912,7 +912,7 @@ ACTION_FUNCTION(A_WolfAttack)
 	};
 
 	ACTION_PARAM_INT(flags, 0);
-	ACTION_PARAM_STRING(sound, 1);
+	ACTION_PARAM_SOUND(sound, 1);
 	ACTION_PARAM_FIXED(snipe, 2);
 	ACTION_PARAM_INT(maxdamage, 3);
 	ACTION_PARAM_INT(blocksize, 4);
@@ -924,7 +924,7 @@ ACTION_FUNCTION(A_WolfAttack)
 	int     hitchance;
 	bool	staletarget = (self->target != NULL && self->target->player == NULL && !(self->target->flags & FL_SHOOTABLE));
 
-	if(sound.Len() == 1 && sound[0] == '*')
+	if(args[1].str.Compare("*") == 0)
 		PlaySoundLocActor(self->attacksound, self);
 	else
 		PlaySoundLocActor(sound, self);
@@ -1461,7 +1461,7 @@ ACTION_FUNCTION(A_GunAttack)
 	int      dx,dy,dist;
 
 	ACTION_PARAM_INT(flags, 0);
-	ACTION_PARAM_STRING(sound, 1);
+	ACTION_PARAM_SOUND(sound, 1);
 	ACTION_PARAM_FIXED(snipe, 2);
 	ACTION_PARAM_INT(maxdamage, 3);
 	ACTION_PARAM_INT(blocksize, 4);
@@ -1475,7 +1475,7 @@ ACTION_FUNCTION(A_GunAttack)
 			return false;
 	}
 
-	if(sound.Len() == 1 && sound[0] == '*')
+	if(args[1].str.Compare("*") == 0)
 		SD_PlaySound(player->ReadyWeapon->attacksound, SD_WEAPONS);
 	else
 		SD_PlaySound(sound, SD_WEAPONS);
@@ -6,6 +6,10 @@
 #include "wl_def.h"
 #include "a_playerpawn.h"
 #include "weaponslots.h"
+#include "tarray.h"
+
+class FTexture;
+struct FRemapTable;
 
 /*
 =============================================================================
@@ -38,6 +42,67 @@ public:
 	virtual void InfoMessage(FString key,
 			const std::vector<FTextureID> &texids = std::vector<FTextureID>()) {}
 	virtual void ClearInfoMessages() {}
+
+protected:
+	// Retained copy of a composited status bar area. Each widget records the
+	// graphics it would draw; only widgets whose graphics changed since the
+	// last frame (and anything overlapping them) get repainted, everything
+	// else is restored from the copy kept of the screen.
+	class FRetainedArea
+	{
+	public:
+		FRetainedArea() : areaX(0), areaY(0), areaW(0), areaH(0),
+			screenW(0), screenH(0), cur(0), valid(false)
+		{
+			background.tex = NULL;
+		}
+
+		void Invalidate() { valid = false; }
+
+		// The double versions take real screen coordinates, the int versions
+		// virtual 320x200 coordinates like VWB_DrawGraphic.
+		void Begin(FTexture *background, double x, double y, double w, double h);
+		void Begin(FTexture *background, int x, int y);
+		void BeginWidget();
+		void AddGraphic(FTexture *tex, double x, double y, double w, double h,
+			FRemapTable *remap=NULL, uint32_t fillcolor=0xFFFFFFFF, int cliptop=0, int clipbottom=0x7FFFFFFF);
+		void AddGraphic(FTexture *tex, int x, int y, FRemapTable *remap=NULL);
+		void Finish();
+
+	private:
+		struct Graphic
+		{
+			FTexture *tex;
+			double x, y, w, h;
+			FRemapTable *remap;
+			uint32_t fillcolor; // As DTA_FillColor, all bits set for none
+			int cliptop, clipbottom;
+
+			bool operator==(const Graphic &other) const;
+			bool operator!=(const Graphic &other) const { return !(*this == other); }
+			void Draw(int cl, int ct, int cr, int cb) const;
+		};
+		struct Widget
+		{
+			unsigned int first, count;
+			int x1, y1, x2, y2;
+		};
+
+		void CalcBounds(Widget &widget) const;
+		bool WidgetChanged(unsigned int i) const;
+
+		// Double buffered so that the previous frame can be compared against
+		// without copying.
+		TArray<Graphic> graphics[2];
+		TArray<Widget> widgets[2];
+		TArray<BYTE> image;
+		TArray<bool> redraw;
+		Graphic background;
+		int areaX, areaY, areaW, areaH;
+		int screenW, screenH;
+		unsigned int cur;
+		bool valid;
+	};
 };
 extern DBaseStatusBar *StatusBar;
 void	CreateStatusBar();
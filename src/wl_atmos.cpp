@@ -7,6 +7,7 @@
 #include "wl_play.h"
 #include "id_ca.h"
 #include "id_vh.h"
+#include "c_cvars.h"
 #include "g_mapinfo.h"
 #include "textures/textures.h"
 #include "v_video.h"
@@ -15,20 +16,43 @@
 
 #define RAINSCALING
 
-#define mapheight (map->GetHeader().height)
-#define mapwidth (map->GetHeader().width)
-
 static constexpr auto MINDIST = 0x5800l;
 
 uint32_t rainpos = 0;
 
-typedef struct {
-    int32_t x, y, z;
-    int32_t waveamp, wavefineangle;
-} point3d_t;
+#define DEFAULTPOINTS 1800
+#define MAXPOINTS 65536
+
+// Particles are processed in fixed size batches. The first pass over a batch
+// does the view space transform for every particle with no branching so the
+// compiler can vectorize it, then the survivors are projected and drawn.
+#define ATMOS_BATCH 256
+
+CUSTOM_CVAR(Int, r_atmosdensity, DEFAULTPOINTS, CVAR_ARCHIVE)
+{
+	if(self < 1)
+		self = 1;
+	else if(self > MAXPOINTS)
+		self = MAXPOINTS;
+}
+
+// Point cloud shared by the star fields, rain and snow stored as a structure
+// of arrays.
+static struct AtmosPoints
+{
+	TArray<int32_t> x, y, z;
+	TArray<int32_t> waveamp, wavefineangle;
+
+	unsigned int Size() const { return x.Size(); }
+} points;
 
-#define MAXPOINTS 1800
-point3d_t points[MAXPOINTS];
+struct AtmosBatch
+{
+	int32_t x[ATMOS_BATCH];
+	int32_t z[ATMOS_BATCH];
+	int32_t obx[ATMOS_BATCH], oby[ATMOS_BATCH];
+	BYTE visible[ATMOS_BATCH];
+};
 
 byte moon[100]={
 	0,  0, 27, 18, 15, 16, 19, 29,  0,  0,
@@ -51,21 +75,46 @@ void Init3DPoints()
 {
     const auto halfviewheight = viewheight >> 1;
     int hvheight = halfviewheight;
-    for(int i = 0; i < MAXPOINTS; i++)
+    const unsigned int numpoints = clamp<int>(r_atmosdensity, 1, MAXPOINTS);
+    points.x.Resize(numpoints);
+    points.y.Resize(numpoints);
+    points.z.Resize(numpoints);
+    points.waveamp.Resize(numpoints);
+    points.wavefineangle.Resize(numpoints);
+    for(unsigned int i = 0; i < numpoints; i++)
     {
-        point3d_t *pt = &points[i];
-        pt->x = 16384 - (rand() & 32767);
-        pt->z = 16384 - (rand() & 32767);
-        pt->waveamp = (rand() & 0x00ffl);
-        pt->wavefineangle = (rand() % FINEANGLES);
-        float len = sqrt((float)pt->x * pt->x + (float)pt->z * pt->z);
+        points.x[i] = 16384 - (rand() & 32767);
+        points.z[i] = 16384 - (rand() & 32767);
+        points.waveamp[i] = (rand() & 0x00ffl);
+        points.wavefineangle[i] = (rand() % FINEANGLES);
+        float len = sqrt((float)points.x[i] * points.x[i] + (float)points.z[i] * points.z[i]);
         int j=50;
         do
         {
-            pt->y = 1024 + (rand() & 8191);
+            points.y[i] = 1024 + (rand() & 8191);
             j--;
         }
-        while(j > 0 && (float)pt->y * 256.F / len >= hvheight);
+        while(j > 0 && (float)points.y[i] * 256.F / len >= hvheight);
+    }
+}
+
+// Regenerates the point cloud if the density has been changed.
+static void CheckAtmosDensity()
+{
+    if(points.Size() != (unsigned int)r_atmosdensity)
+        Init3DPoints();
+}
+
+// Rotates a batch of star field points into view space.
+static void TransformStars(AtmosBatch &batch, unsigned int first, unsigned int count)
+{
+    const int32_t *px = &points.x[first];
+    const int32_t *pz = &points.z[first];
+    for(unsigned int i = 0; i < count; i++)
+    {
+        batch.x[i] = px[i] * viewcos + pz[i] * viewsin;
+        batch.z[i] = (pz[i] * viewcos - px[i] * viewsin) >> 8;
+        batch.visible[i] = batch.z[i] > 0 && (batch.z[i] >> 18) <= 15;
     }
 }
 
@@ -80,27 +129,33 @@ void DrawHighQualityStarSky(byte *vbuf, uint32_t vbufPitch)
 	for(i = 0; i < hvheight; i++, ptr += vbufPitch)
 		memset(ptr, 0, viewwidth);
 
-	for(i = 0; i < MAXPOINTS; i++)
+	CheckAtmosDensity();
+
+	AtmosBatch batch;
+	const unsigned int numpoints = points.Size();
+	for(unsigned int first = 0; first < numpoints; first += ATMOS_BATCH)
 	{
-		point3d_t *pt = &points[i];
-		int32_t x = pt->x * viewcos + pt->z * viewsin;
-		int32_t y = pt->y << 16;
-		int32_t z = (pt->z * viewcos - pt->x * viewsin) >> 8;
-		if(z <= 0) continue;
-		int shade = z >> 18;
-		if(shade > 15) continue;
-		int32_t xx = x / z + hvwidth;
-		int32_t yy = hvheight - y / z;
-		if(xx >= 1 && xx < viewwidth - 1 && yy >= 1 && yy < hvheight - 1)
+		const unsigned int count = MIN<unsigned int>(ATMOS_BATCH, numpoints - first);
+		TransformStars(batch, first, count);
+
+		for(unsigned int j = 0; j < count; j++)
 		{
-			vbuf[yy * vbufPitch + xx] = shade + 15;
-			if (15 - shade > 1)
+			if(!batch.visible[j]) continue;
+			int32_t z = batch.z[j];
+			int shade = z >> 18;
+			int32_t xx = batch.x[j] / z + hvwidth;
+			int32_t yy = hvheight - (points.y[first + j] << 16) / z;
+			if(xx >= 1 && xx < viewwidth - 1 && yy >= 1 && yy < hvheight - 1)
 			{
-				shade = 15 - ((15 - shade) >> 1);
-				vbuf[yy * vbufPitch + xx + 1] =
-					vbuf[yy * vbufPitch + xx - 1] =
-					vbuf[(yy + 1) * vbufPitch + xx] =
-					vbuf[(yy - 1) * vbufPitch + xx] = shade + 15;
+				vbuf[yy * vbufPitch + xx] = shade + 15;
+				if (15 - shade > 1)
+				{
+					shade = 15 - ((15 - shade) >> 1);
+					vbuf[yy * vbufPitch + xx + 1] =
+						vbuf[yy * vbufPitch + xx - 1] =
+						vbuf[(yy + 1) * vbufPitch + xx] =
+						vbuf[(yy - 1) * vbufPitch + xx] = shade + 15;
+				}
 			}
 		}
 	}
@@ -113,12 +168,12 @@ void DrawHighQualityStarSky(byte *vbuf, uint32_t vbufPitch)
 	{
 		int pointInd = levelInfo->Atmos[3];
 		pointInd = (
-			pointInd == 1 || pointInd < 0 || pointInd >= MAXPOINTS) ? 10 : pointInd;
+			pointInd == 1 || pointInd < 0 || pointInd >= (int)numpoints) ? 10 : pointInd;
+		if(pointInd >= (int)numpoints) return;
 
-		point3d_t *pt = &points[pointInd];
-		int32_t x = pt->x * viewcos + pt->z * viewsin;
-		int32_t y = pt->y << 16;
-		int32_t z = (pt->z * viewcos - pt->x * viewsin) >> 8;
+		int32_t x = points.x[pointInd] * viewcos + points.z[pointInd] * viewsin;
+		int32_t y = points.y[pointInd] << 16;
+		int32_t z = (points.z[pointInd] * viewcos - points.x[pointInd] * viewsin) >> 8;
 		if(z <= 0) return;
 		int32_t xx = x / z + hvwidth;
 		int32_t yy = hvheight - y / z;
@@ -156,19 +211,24 @@ void DrawStarSky(byte *vbuf, uint32_t vbufPitch)
 	for(i = 0; i < hvheight; i++, ptr += vbufPitch)
 		memset(ptr, 0, viewwidth);
 
-	for(i = 0; i < MAXPOINTS; i++)
+	CheckAtmosDensity();
+
+	AtmosBatch batch;
+	const unsigned int numpoints = points.Size();
+	for(unsigned int first = 0; first < numpoints; first += ATMOS_BATCH)
 	{
-		point3d_t *pt = &points[i];
-		int32_t x = pt->x * viewcos + pt->z * viewsin;
-		int32_t y = pt->y << 16;
-		int32_t z = (pt->z * viewcos - pt->x * viewsin) >> 8;
-		if(z <= 0) continue;
-		int shade = z >> 18;
-		if(shade > 15) continue;
-		int32_t xx = x / z + hvwidth;
-		int32_t yy = hvheight - y / z;
-		if(xx >= 0 && xx < viewwidth && yy >= 0 && yy < hvheight)
-			vbuf[yy * vbufPitch + xx] = shade + 15;
+		const unsigned int count = MIN<unsigned int>(ATMOS_BATCH, numpoints - first);
+		TransformStars(batch, first, count);
+
+		for(unsigned int j = 0; j < count; j++)
+		{
+			if(!batch.visible[j]) continue;
+			int32_t z = batch.z[j];
+			int32_t xx = batch.x[j] / z + hvwidth;
+			int32_t yy = hvheight - (points.y[first + j] << 16) / z;
+			if(xx >= 0 && xx < viewwidth && yy >= 0 && yy < hvheight)
+				vbuf[yy * vbufPitch + xx] = (z >> 18) + 15;
+		}
 	}
 
 	int32_t x = 16384 * viewcos + 16384 * viewsin;
@@ -270,23 +330,90 @@ static void DrawRainSplash(byte *vbuf, uint32_t vbufPitch, int x, int y,
     }
 }
 
+// Converts a particle's world position into screen coordinates at the given
+// height (-0x8000 being the floor). Returns false if the particle is off
+// screen or hidden behind a wall.
+static bool ProjectAtmosPoint(int32_t obx, int32_t oby, int32_t y, int32_t &xx, int32_t &yy)
+{
+    const int halfviewheight = viewheight >> 1;
+    fixed nx,ny;
+    nx = FixedMul(obx-viewx,viewcos)-FixedMul(oby-viewy,viewsin);
+    ny = FixedMul(oby-viewy,viewcos)+FixedMul(obx-viewx,viewsin);
+
+    if (nx<MINDIST)                 // too close, don't overflow the divide
+        return false;
+
+    xx = (word)(centerx + ny*scale/nx);
+    if(!(xx >= 0 && xx < viewwidth))
+        return false;
+
+    unsigned pscale;
+    int upperedge;
+
+    auto pheight = (word)(heightnumerator/(nx>>8));
+    if(wallheight[xx][0]>pheight)
+        return false;
+
+    pscale=pheight>>3;                 // low three bits are fractional
+    if(!pscale)
+        return false;
+    upperedge=halfviewheight-pscale;
+    yy = lwlib::lerpi(upperedge+pscale*2, upperedge, y+0x8000, TILEGLOBAL);
+    return yy > 0 && yy < viewheight;
+}
+
+// Rotates a batch of particles, which wrap around the camera, into view space
+// and finds their world position. The particle offsets are passed in so that
+// snow can perturb them first.
+static void TransformParticles(AtmosBatch &batch, const int32_t *ptx, const int32_t *ptz, unsigned int count, fixed px, fixed pz)
+{
+    const float dirx = (float)(viewcos / 65536.0);
+    const float diry = (float)(-viewsin / 65536.0);
+    const float eyex = (float)(viewx / 65536.0);
+    const float eyey = (float)(viewy / 65536.0);
+
+    for(unsigned int i = 0; i < count; i++)
+    {
+        int32_t ax = ptx[i] + px;
+        ax = 0x1fff - (ax & 0x3fff);
+        int32_t az = ptz[i] + pz;
+        az = 0x1fff - (az & 0x3fff);
+        const int32_t x = ax * viewcos + az * viewsin;
+        const int32_t z = (az * viewcos - ax * viewsin) >> 8;
+        batch.x[i] = x;
+        batch.z[i] = z;
+        batch.visible[i] = z > 0 && (z >> 17) <= 13;
+
+        const float vz = (float)((z>>2)/65536.0);
+        const float vx = (float)((x>>10)/65536.0);
+        batch.obx[i] = (int32_t)((eyex + vz * dirx - vx * diry)*TILEGLOBAL);
+        batch.oby[i] = (int32_t)((eyey + vz * diry + vx * dirx)*TILEGLOBAL);
+    }
+}
+
+namespace Shading
+{
+    bool HasCeiling (unsigned int x, unsigned int y);
+}
+
+// Checks if a particle is outdoors (there is no ceiling over it).
+static bool AtmosPointOutside(int32_t obx, int32_t oby)
+{
+    return !Shading::HasCeiling(obx>>TILESHIFT, oby>>TILESHIFT);
+}
+
 void DrawRain(byte *vbuf, uint32_t vbufPitch, byte *zbuf, uint32_t zbufPitch)
 {
-    fixed dist;                                // distance to row projection
-    fixed tex_step;                            // global step per one screen pixel
-    fixed gu, gv, floorx, floory;              // global texture coordinates
-    fixed px = (players[0].camera->y + FixedMul(0x7900, viewsin)) >> 6;
-    fixed pz = (players[0].camera->x - FixedMul(0x7900, viewcos)) >> 6;
-    int32_t ax, az, x, y, z, xx, yy, height, actheight;
+    // Recover the camera position from the view variables rather than
+    // reading the camera since this may be drawn on the render thread.
+    fixed px = (viewy - FixedMul(focallength, viewsin) + FixedMul(0x7900, viewsin)) >> 6;
+    fixed pz = (viewx + FixedMul(focallength, viewcos) - FixedMul(0x7900, viewcos)) >> 6;
+    int32_t y, z, xx, yy;
     int shade;
-    const auto halfviewheight = viewheight >> 1;
-    int hvheight = halfviewheight;
-    int hvwidth = viewwidth >> 1;
 
     rainpos -= (tics * 1100);
 
 #ifdef RAINSCALING
-    int32_t y2, yy2;
     int rainlenyy;
 
     const auto raindropmove = 0x4000;
@@ -296,151 +423,69 @@ void DrawRain(byte *vbuf, uint32_t vbufPitch, byte *zbuf, uint32_t zbufPitch)
     const int rainmaxlen = scaleFactorX*5;
 #endif
 
-    for(int i = 0; i < MAXPOINTS; i++)
-    {
-        point3d_t *pt = &points[i];
-        ax = pt->x + px;
-        ax = 0x1fff - (ax & 0x3fff);
-        az = pt->z + pz;
-        az = 0x1fff - (az & 0x3fff);
-        x = ax * viewcos + az * viewsin;
-
-        y = (((pt->y << 6) + rainpos) & 0x0ffff) - 0x8000;
+    CheckAtmosDensity();
 
-        bool showsplash=false;
-        if(y+0x8000<raindropmove)
-        {
-            showsplash=true;
-        }
-        else
-        {
-            y = FixedDiv((y+0x8000)-raindropmove,TILEGLOBAL-raindropmove)-0x8000;
-        }
+    AtmosBatch batch;
+    const unsigned int numpoints = points.Size();
+    for(unsigned int first = 0; first < numpoints; first += ATMOS_BATCH)
+    {
+        const unsigned int count = MIN<unsigned int>(ATMOS_BATCH, numpoints - first);
+        TransformParticles(batch, &points.x[first], &points.z[first], count, px, pz);
 
-        z = (az * viewcos - ax * viewsin) >> 8;
-        if(z <= 0) continue;
-        shade = z >> 17;
-        if(shade > 13) continue;
-        auto dir = lwlib::vec2f(viewcos / 65536.0, -viewsin / 65536.0);
-        auto viewpt = lwlib::vec2f((z>>2)/65536.0, (x>>10)/65536.0);
-        auto eye = lwlib::vec2f(viewx / 65536.0, viewy / 65536.0);
-        auto p = eye + viewpt.v[0] * dir + viewpt.v[1] * vec_rot90(dir);
-        int32_t obx = (int32_t)(p.v[0]*TILEGLOBAL);
-        int32_t oby = (int32_t)(p.v[1]*TILEGLOBAL);
-        //xx = x*scale/z + hvwidth;
-        //xx = (int32_t)(viewpt.v[1]*scale/viewpt.v[0])+hvwidth;
-        auto compute_xx_yy = [obx, oby, zbuf, zbufPitch, halfviewheight](
-                int32_t y, bool &bail)
+        for(unsigned int j = 0; j < count; j++)
         {
-            int32_t xx, yy;
-
-            fixed nx,ny;
-            nx = FixedMul(obx-viewx,viewcos)-FixedMul(oby-viewy,viewsin);
-            ny = FixedMul(oby-viewy,viewcos)+FixedMul(obx-viewx,viewsin);
-
-            if (nx<MINDIST)                 // too close, don't overflow the divide
-            {
-                bail=true;
-                return std::make_pair(0, 0);
-            }
-
-            xx = (word)(centerx + ny*scale/nx);
-            if(!(xx >= 0 && xx < viewwidth))
-            {
-                bail=true;
-                return std::make_pair(0, 0);
-            }
-
-            unsigned scale;
-            int upperedge;
+            if(!batch.visible[j])
+                continue;
 
-            auto viewheight = (word)(heightnumerator/(nx>>8));
-            if(wallheight[xx][0]>viewheight)
-            {
-                bail=true;
-                return std::make_pair(0, 0);
-            }
+            z = batch.z[j];
+            shade = z >> 17;
+            y = (((points.y[first + j] << 6) + rainpos) & 0x0ffff) - 0x8000;
 
-            scale=viewheight>>3;                 // low three bits are fractional
-            if(!scale)
+            bool showsplash=false;
+            if(y+0x8000<raindropmove)
             {
-                bail=true;
-                return std::make_pair(0, 0);
+                showsplash=true;
             }
-            upperedge=halfviewheight-scale;
-            //yy = upperedge+scale*2;
-            yy = lwlib::lerpi(upperedge+scale*2, upperedge, y+0x8000, TILEGLOBAL);
-            if(!(yy > 0 && yy < viewheight))
+            else
             {
-                bail=true;
-                return std::make_pair(0, 0);
+                y = FixedDiv((y+0x8000)-raindropmove,TILEGLOBAL-raindropmove)-0x8000;
             }
 
-            auto zdepth=std::min(scale*255/halfviewheight,255u);
-
-            //if(zdepth < zbuf[xx*zbufPitch+yy])
-            //{
-            //    bail=true;
-            //    return std::make_pair(0, 0);
-            //}
-
-            return std::make_pair(xx,yy);
-        };
-        bool bail = false;
-        auto xx_yy = compute_xx_yy(y, bail);
-        if(bail)
-            continue;
-        xx = xx_yy.first;
-        yy = xx_yy.second;
+            if(!ProjectAtmosPoint(batch.obx[j], batch.oby[j], y, xx, yy))
+                continue;
 #ifdef RAINSCALING
-        rainlenyy = LABS((raindropmove << 11) / z);
-        rainlenyy = std::min(rainlenyy, (int)(20*scaleFactorY));
-        rainlenyy = std::max(rainlenyy, (int)(scaleFactorY*3));
-        rainlenyy = lwlib::lerpi(rainminlen, rainmaxlen+1,
-                                 (rainlenyy-(scaleFactorY*3)),
-                                 (20*scaleFactorY)-(scaleFactorY*3)+1);
-        //printf("yylen=%d rainlenyy=%d shade=%d viewpt.x=%.3f\n", LABS(yy2-yy), rainlenyy, shade, viewpt.v[0]);
+            rainlenyy = LABS((raindropmove << 11) / z);
+            rainlenyy = std::min(rainlenyy, (int)(20*scaleFactorY));
+            rainlenyy = std::max(rainlenyy, (int)(scaleFactorY*3));
+            rainlenyy = lwlib::lerpi(rainminlen, rainmaxlen+1,
+                                     (rainlenyy-(scaleFactorY*3)),
+                                     (20*scaleFactorY)-(scaleFactorY*3)+1);
 #endif
-        height = (heightnumerator << 10) / z;
-        //if(actheight < 0) actheight = -actheight;
-        //if(actheight < (wallheight[xx] >> 3) && height < wallheight[xx]) continue;
 
-        // Find the rain's tile coordinate
-        floorx = (int32_t(p.v[0]*TILEGLOBAL)>>TILESHIFT)%mapwidth;
-        floory = (int32_t(p.v[1]*TILEGLOBAL)>>TILESHIFT)%mapheight;
+            if(!AtmosPointOutside(batch.obx[j], batch.oby[j]))
+                continue;
 
-        const MapSpot spot = map->GetSpot(floorx, floory, 0);
-        if(spot->sector == nullptr ||
-                !spot->sector->texture[MapSector::Ceiling].isValid())
-        {
 #ifdef RAINSCALING
             if(!showsplash)
             {
                 if(xx - rainwid > 0 && xx < viewwidth &&
                    yy - rainlenyy > 0 && yy < viewheight)
                 {
-                    for(int j = 0; j < rainwid; j++)
+                    for(int k = 0; k < rainlenyy; k++)
                     {
-                        for(int k = 0; k < rainlenyy; k++)
-                        {
-                            vbuf[(yy - k) * vbufPitch + xx - j] = shade+
-                                lwlib::lerpi(15,18,k,rainlenyy);
-                        }
+                        const byte col = shade+lwlib::lerpi(15,18,k,rainlenyy);
+                        byte *dest = &vbuf[(yy - k) * vbufPitch + xx - rainwid + 1];
+                        memset(dest, col, rainwid);
                     }
                 }
             }
             else
             {
-                //(y+0x8000<raindropmove)
                 const auto ydist = raindropmove;
                 auto frame = (y+0x8000)/(ydist/3);
                 frame = lwlib::clip((int)frame, 0, 2);
-                bool bail = false;
-                auto xx_yy = compute_xx_yy(-0x8000, bail);
-                if(bail)
+                if(!ProjectAtmosPoint(batch.obx[j], batch.oby[j], -0x8000, xx, yy))
                     continue;
-                xx = xx_yy.first;
-                yy = xx_yy.second;
                 DrawRainSplash(vbuf, vbufPitch, xx, yy, rainlenyy,
                             shade+15, frame);
             }
@@ -491,17 +536,10 @@ fixed SnowWindAmplitude(uint32_t windtics)
 static FRandom pr_snow("Snow");
 void DrawSnow(byte *vbuf, uint32_t vbufPitch, byte *zbuf, uint32_t zbufPitch)
 {
-    fixed dist;                                // distance to row projection
-    fixed tex_step;                            // global step per one screen pixel
-    fixed gu, gv, floorx, floory;              // global texture coordinates
-    fixed px = (players[0].camera->y + FixedMul(0x7900, viewsin)) >> 6;
-    fixed pz = (players[0].camera->x - FixedMul(0x7900, viewcos)) >> 6;
-    int32_t ax, az, x, y, z, xx, yy, height, actheight;
+    fixed px = (viewy - FixedMul(focallength, viewsin) + FixedMul(0x7900, viewsin)) >> 6;
+    fixed pz = (viewx + FixedMul(focallength, viewcos) - FixedMul(0x7900, viewcos)) >> 6;
+    int32_t y, xx, yy;
     int shade;
-    const auto halfviewheight = viewheight >> 1;
-    int hvheight = halfviewheight;
-    int hvwidth = viewwidth >> 1;
-    point3d_t wavept;
 
     static uint32_t windtics = 2000;
     static uint32_t maxwindtics = 2000;
@@ -515,132 +553,65 @@ void DrawSnow(byte *vbuf, uint32_t vbufPitch, byte *zbuf, uint32_t zbufPitch)
     }
 
     rainpos -= (tics * 230);
-    for(int i = 0; i < MAXPOINTS; i++)
-    {
-        wavept = points[i];
-
-        fixed windamp = 0;
-        if ((int)windtics < 1200 - (i * 200 / MAXPOINTS))
-        {
-            windamp = SnowWindAmplitude(windtics - 200 + (i * 200 / MAXPOINTS));
-        }
-
-        {
-            fixed t = (((wavept.y << 6) + rainpos) & 0x0ffff);
-            fixed amp = finesine[(t * FINEANGLES) >> 16l];
-            amp = FixedMul(amp, wavept.waveamp);
-            wavept.x = wavept.x + FixedMul(amp, finecosine[wavept.wavefineangle]);
-            wavept.z = wavept.z - FixedMul(amp, finesine[wavept.wavefineangle]);
-            wavept.x = wavept.x + FixedMul(windamp, finecosine[windangle]);
-            wavept.z = wavept.z - FixedMul(windamp, finesine[windangle]);
-        }
-        point3d_t *pt = &wavept;
-        ax = pt->x + px;
-        ax = 0x1fff - (ax & 0x3fff);
-        az = pt->z + pz;
-        az = 0x1fff - (az & 0x3fff);
-        x = ax * viewcos + az * viewsin;
-        y = (((pt->y << 6) + rainpos) & 0x0ffff) - 0x8000;
-        z = (az * viewcos - ax * viewsin) >> 8;
-        if(z <= 0) continue;
-        shade = z >> 17;
-        if(shade > 13) continue;
-        auto dir = lwlib::vec2f(viewcos / 65536.0, -viewsin / 65536.0);
-        auto viewpt = lwlib::vec2f((z>>2)/65536.0, (x>>10)/65536.0);
-        auto eye = lwlib::vec2f(viewx / 65536.0, viewy / 65536.0);
-        auto p = eye + viewpt.v[0] * dir + viewpt.v[1] * vec_rot90(dir);
-        int32_t obx = (int32_t)(p.v[0]*TILEGLOBAL);
-        int32_t oby = (int32_t)(p.v[1]*TILEGLOBAL);
-        //xx = x*scale/z + hvwidth;
-        //xx = (int32_t)(viewpt.v[1]*scale/viewpt.v[0])+hvwidth;
-        auto compute_xx_yy = [obx, oby, zbuf, zbufPitch, halfviewheight](
-                int32_t y, bool &bail)
-        {
-            int32_t xx, yy;
 
-            fixed nx,ny;
-            nx = FixedMul(obx-viewx,viewcos)-FixedMul(oby-viewy,viewsin);
-            ny = FixedMul(oby-viewy,viewcos)+FixedMul(obx-viewx,viewsin);
+    CheckAtmosDensity();
 
-            if (nx<MINDIST)                 // too close, don't overflow the divide
-            {
-                bail=true;
-                return std::make_pair(0, 0);
-            }
-
-            xx = (word)(centerx + ny*scale/nx);
-            if(!(xx >= 0 && xx < viewwidth))
-            {
-                bail=true;
-                return std::make_pair(0, 0);
-            }
-
-            unsigned scale;
-            int upperedge;
+    AtmosBatch batch;
+    int32_t wavex[ATMOS_BATCH], wavez[ATMOS_BATCH];
+    const unsigned int numpoints = points.Size();
+    for(unsigned int first = 0; first < numpoints; first += ATMOS_BATCH)
+    {
+        const unsigned int count = MIN<unsigned int>(ATMOS_BATCH, numpoints - first);
 
-            auto viewheight = (word)(heightnumerator/(nx>>8));
-            if(wallheight[xx][0]>viewheight)
-            {
-                bail=true;
-                return std::make_pair(0, 0);
-            }
+        // Blow the flakes around before transforming them
+        for(unsigned int j = 0; j < count; j++)
+        {
+            const unsigned int i = first + j;
 
-            scale=viewheight>>3;                 // low three bits are fractional
-            if(!scale)
-            {
-                bail=true;
-                return std::make_pair(0, 0);
-            }
-            upperedge=halfviewheight-scale;
-            //yy = upperedge+scale*2;
-            yy = lwlib::lerpi(upperedge+scale*2, upperedge, y+0x8000, TILEGLOBAL);
-            if(!(yy > 0 && yy < viewheight))
+            fixed windamp = 0;
+            if ((int)windtics < 1200 - (int)(i * 200 / numpoints))
             {
-                bail=true;
-                return std::make_pair(0, 0);
+                windamp = SnowWindAmplitude(windtics - 200 + (i * 200 / numpoints));
             }
 
-            auto zdepth=std::min(scale*255/halfviewheight,255u);
+            fixed t = (((points.y[i] << 6) + rainpos) & 0x0ffff);
+            fixed amp = finesine[(t * FINEANGLES) >> 16l];
+            amp = FixedMul(amp, points.waveamp[i]);
+            wavex[j] = points.x[i] + FixedMul(amp, finecosine[points.wavefineangle[i]]);
+            wavez[j] = points.z[i] - FixedMul(amp, finesine[points.wavefineangle[i]]);
+            wavex[j] = wavex[j] + FixedMul(windamp, finecosine[windangle]);
+            wavez[j] = wavez[j] - FixedMul(windamp, finesine[windangle]);
+        }
 
-            //if(zdepth < zbuf[xx*zbufPitch+yy])
-            //{
-            //    bail=true;
-            //    return std::make_pair(0, 0);
-            //}
+        TransformParticles(batch, wavex, wavez, count, px, pz);
 
-            return std::make_pair(xx,yy);
-        };
-        bool bail = false;
-        auto xx_yy = compute_xx_yy(y, bail);
-        if(bail)
-            continue;
-        xx = xx_yy.first;
-        yy = xx_yy.second;
+        for(unsigned int j = 0; j < count; j++)
+        {
+            if(!batch.visible[j])
+                continue;
 
-        // Find the rain's tile coordinate
-        floorx = (int32_t(p.v[0]*TILEGLOBAL)>>TILESHIFT)%mapwidth;
-        floory = (int32_t(p.v[1]*TILEGLOBAL)>>TILESHIFT)%mapheight;
+            shade = batch.z[j] >> 17;
+            y = (((points.y[first + j] << 6) + rainpos) & 0x0ffff) - 0x8000;
 
-        if(xx > 0 && xx < viewwidth-1 && yy > 0 && yy < viewheight-1)
-        {
-            // Is there a ceiling tile?
-            const MapSpot spot = map->GetSpot(floorx, floory, 0);
-            if(spot->sector != nullptr &&
-                    spot->sector->texture[MapSector::Ceiling].isValid())
-            {
+            if(!ProjectAtmosPoint(batch.obx[j], batch.oby[j], y, xx, yy))
                 continue;
-            }
 
-            if(shade < 10)
-            {
-                vbuf[yy * vbufPitch + xx] = shade+17;
-                vbuf[yy * vbufPitch + xx - 1] = shade+16;
-                vbuf[(yy - 1) * vbufPitch + xx] = shade+16;
-                vbuf[(yy - 1) * vbufPitch + xx - 1] = shade+15;
-            }
-            else
+            if(xx > 0 && xx < viewwidth-1 && yy > 0 && yy < viewheight-1)
             {
-                vbuf[yy * vbufPitch + xx] = shade+15;
+                if(!AtmosPointOutside(batch.obx[j], batch.oby[j]))
+                    continue;
+
+                if(shade < 10)
+                {
+                    vbuf[yy * vbufPitch + xx] = shade+17;
+                    vbuf[yy * vbufPitch + xx - 1] = shade+16;
+                    vbuf[(yy - 1) * vbufPitch + xx] = shade+16;
+                    vbuf[(yy - 1) * vbufPitch + xx - 1] = shade+15;
+                }
+                else
+                {
+                    vbuf[yy * vbufPitch + xx] = shade+15;
+                }
             }
         }
     }
@@ -18,7 +18,7 @@
 #include "g_mapinfo.h"
 #include "actor.h"
 #include "language.h"
-#include "m_png.h"
+#include "m_capture.h"
 #include "wl_agent.h"
 #include "wl_debug.h"
 #include "wl_draw.h"
@@ -107,15 +107,7 @@ void PictureGrabber (void)
 	}
 
 	// overwrites WSHOT999.PNG if all wshot files exist
-	const BYTE* buffer;
-	int pitch;
-	ESSType color_type;
-	screen->GetScreenshotBuffer(buffer, pitch, color_type);
-	FILE *file = File(screenshotDir + PATH_SEPARATOR + fname).open("wb");
-	M_CreatePNG(file, buffer, GPalette.BaseColors, color_type, SCREENWIDTH, SCREENHEIGHT, pitch);
-	M_FinishPNG(file);
-	fclose(file);
-	screen->ReleaseScreenshotBuffer();
+	M_CaptureScreenshot(screenshotDir + PATH_SEPARATOR + fname);
 
 	US_CenterWindow (18,2);
 	US_PrintCentered ("Screenshot taken");
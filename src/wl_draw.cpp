@@ -1,6 +1,9 @@
 // WL_DRAW.C
 
 #include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include "wl_def.h"
 #include "id_sd.h"
 #include "id_in.h"
@@ -55,6 +58,8 @@
 
 namespace Shading
 {
+	void SnapshotMap (void);
+
 	void PopulateHalos (void);
 
 	int LightForIntercept (fixed xintercept, fixed yintercept);
@@ -289,6 +294,8 @@ TWallHeight CalcHeight()
 */
 
 const byte *postsource;
+FTexture *posttexture; // Texture and column postsource points into
+unsigned postcolumn;
 int postx;
 int32_t postshadex, postshadey;
 bool postbright, postdecal;
@@ -296,28 +303,33 @@ byte postdecalcolor = 187; // slade will not set the right color for this; its a
 
 struct StandardScalePost
 {
+	enum { Masked = false };
+
 	static inline void WritePix(int yendoffs, byte col)
 	{
 		vbuf[yendoffs] = col;
 	}
 
-	static inline byte ReadColor(const byte *curshades, int yw)
+	static inline byte ReadColor(const byte *source, const byte *curshades, int yw)
 	{
-		return curshades[postsource[yw]];
+		return curshades[source[yw]];
 	}
 };
 
 struct DecalScalePost
 {
+	// Leaves holes, which averaged mip levels would smear
+	enum { Masked = true };
+
 	static inline void WritePix(int yendoffs, byte col)
 	{
 		if(col != postdecalcolor)
 			vbuf[yendoffs] = col;
 	}
 
-	static inline byte ReadColor(const byte *curshades, int yw)
+	static inline byte ReadColor(const byte *source, const byte *curshades, int yw)
 	{
-		auto col = postsource[yw];
+		auto col = source[yw];
 		return (col == postdecalcolor ? postdecalcolor : curshades[col]);
 	}
 };
@@ -343,6 +355,29 @@ void RunScalePost()
 	if(yd <= 0)
 		yd = 100;
 
+	// With more than two texels per pixel step down to the mip level that
+	// brings it back under two. Each level halves the texel step, so the
+	// scale has to stay divisible down to the level picked. The column isn't
+	// wrapped for scaled textures the way GetColumn wraps it, but anything
+	// with mipmaps is a power of two wide so masking takes care of that.
+	const byte *source = postsource;
+	int yscale = texyscale;
+	if(vid_mipmaps && !Algo::Masked && posttexture)
+	{
+		const int levels = posttexture->GetMipLevels();
+		int level = 0;
+		while(level < levels && yscale >= yd*2 && !(yscale & 7))
+		{
+			yscale >>= 1;
+			++level;
+		}
+		if(level)
+		{
+			const unsigned column = postcolumn & (posttexture->GetWidth()-1);
+			source = posttexture->GetMipmap(level) + (column>>level)*(posttexture->GetHeight()>>level);
+		}
+	}
+
 	// Calculate starting and ending offsets
 	{
 		int ywcount = wallheight[postx][1]>>3;
@@ -354,12 +389,12 @@ void RunScalePost()
 
 		ywcount = wallheight[postx][2]>>3;
 		yendoffs = (viewheight / 2) + ywcount;
-		yw=(texyscale>>2)-1;
+		yw=(yscale>>2)-1;
 	}
 
 	while(yendoffs >= viewheight)
 	{
-		ywcount -= texyscale;
+		ywcount -= yscale;
 		while(ywcount <= 0)
 		{
 			ywcount += yd;
@@ -368,14 +403,14 @@ void RunScalePost()
 		yendoffs--;
 	}
 	if(yw < 0)
-		yw = (texyscale>>2) - ((-yw) % (texyscale>>2));
+		yw = (yscale>>2) - ((-yw) % (yscale>>2));
 
-	col = Algo::ReadColor(curshades, yw);
+	col = Algo::ReadColor(source, curshades, yw);
 	yendoffs = yendoffs * vbufPitch + postx;
 	while(yoffs <= yendoffs)
 	{
 		Algo::WritePix(yendoffs, col);
-		ywcount -= texyscale;
+		ywcount -= yscale;
 		if(ywcount <= 0)
 		{
 			do
@@ -384,8 +419,8 @@ void RunScalePost()
 				yw--;
 			}
 			while(ywcount <= 0);
-			if(yw < 0) yw = (texyscale>>2)-1;
-			col = Algo::ReadColor(curshades, yw);
+			if(yw < 0) yw = (yscale>>2)-1;
+			col = Algo::ReadColor(source, curshades, yw);
 		}
 		yendoffs -= vbufPitch;
 	}
@@ -514,7 +549,7 @@ void HitVertWall (void)
 
 	DetermineHitDir(true);
 
-	tilehit->amFlags |= AM_Visible;
+	tilehit->SetMapped();
 	texture = (yintercept+texdelta+SlideTextureOffset(tilehit->slideStyle, (word)yintercept, tilehit->slideAmount[hitdir]))&(FRACUNIT-1);
 	if (xtilestep == -1 && !tilehit->tile->offsetVertical)
 	{
@@ -537,6 +572,7 @@ void HitVertWall (void)
 		skywallheight[pixx] = (tilehit->tile->showSky ? TWallHeight{} : wallheight[pixx]);
 		if(postsource)
 			postsource+=(texture-lasttexture)*texheight/texxscale;
+		postcolumn = texture/texxscale;
 		postbright = tilehit->tile->bright;
 		postdecal = tilehit->tile->decal;
 		postx=pixx;
@@ -570,9 +606,14 @@ void HitVertWall (void)
 		texture -= texture%texxscale;
 
 		postsource = source->GetColumn(texture/texxscale, NULL);
+		posttexture = source;
+		postcolumn = texture/texxscale;
 	}
 	else
+	{
 		postsource = NULL;
+		posttexture = NULL;
+	}
 
 	lasttexture=texture;
 }
@@ -598,7 +639,7 @@ void HitHorizWall (void)
 
 	DetermineHitDir(false);
 
-	tilehit->amFlags |= AM_Visible;
+	tilehit->SetMapped();
 	texture = (xintercept+texdelta+SlideTextureOffset(tilehit->slideStyle, (word)xintercept, tilehit->slideAmount[hitdir]))&(FRACUNIT-1);
 	if(!tilehit->tile->offsetHorizontal)
 	{
@@ -623,6 +664,7 @@ void HitHorizWall (void)
 		skywallheight[pixx] = (tilehit->tile->showSky ? TWallHeight{} : wallheight[pixx]);
 		if(postsource)
 			postsource+=(texture-lasttexture)*texheight/texxscale;
+		postcolumn = texture/texxscale;
 		postbright = tilehit->tile->bright;
 		postdecal = tilehit->tile->decal;
 		postx=pixx;
@@ -656,9 +698,14 @@ void HitHorizWall (void)
 		texture -= texture%texxscale;
 
 		postsource = source->GetColumn(texture/texxscale, NULL);
+		posttexture = source;
+		postcolumn = texture/texxscale;
 	}
 	else
+	{
 		postsource = NULL;
+		posttexture = NULL;
+	}
 
 	lasttexture=texture;
 }
@@ -694,37 +741,58 @@ unsigned int CalcRotate (AActor *ob)
 	return angle/ANGLE_45;
 }
 
+#define MAXVISABLE 500
+
+//
+// Everything the second half of the refresh needs from the game state. This
+// is filled in on the main thread, after which the floors, sprites and
+// weapon can be drawn on the render thread while the next tics run.
+//
+static struct RenderSnapshot
+{
+	TArray<R_VisSprite> sprites;
+	R_PlayerSprite psprites[player_t::NUM_PSPRITES];
+	unsigned int numpsprites;
+} snapshot;
+
+static void AddVisSprite (AActor *obj)
+{
+	if (snapshot.sprites.Size() >= MAXVISABLE)    // don't let it overflow
+		return;
+
+	R_VisSprite &vis = snapshot.sprites[snapshot.sprites.Reserve(1)];
+	vis.frame = obj->state;
+	vis.sprite = obj->sprite;
+	vis.rotation = CalcRotate(obj);
+	vis.x = obj->x;
+	vis.y = obj->y;
+	vis.z = obj->z;
+	vis.angle = obj->angle;
+	vis.scaleX = obj->scaleX;
+	vis.scaleY = obj->scaleY;
+	vis.absx = obj->absx;
+	vis.absy = obj->absy;
+	vis.litfilter = obj->litfilter;
+	vis.viewx = obj->viewx;
+	vis.viewheight = obj->viewheight;
+	vis.flip = obj->FlipSprite;
+	vis.bright = (obj->flags & FL_BRIGHT) != 0;
+	vis.billboard = (obj->flags & FL_BILLBOARD) != 0;
+}
+
 /*
 =====================
 =
-= DrawScaleds
+= CollectScaleds
 =
-= Draws all objects that are visable
+= Transforms the visible objects into the snapshot
 =
 =====================
 */
 
-#define MAXVISABLE 500
-
-typedef struct
+void CollectScaleds (void)
 {
-	AActor *actor;
-	short viewheight;
-	//short      viewx,
-	//		viewheight,
-	//		shapenum;
-	//short      flags;          // this must be changed to uint32_t, when you
-							// you need more than 16-flags for drawing
-} visobj_t;
-
-visobj_t vislist[MAXVISABLE];
-visobj_t *visptr,*visstep,*farthest;
-
-void DrawScaleds (void)
-{
-	int      i,least,numvisable,height;
-
-	visptr = &vislist[0];
+	snapshot.sprites.Clear();
 
 //
 // place active objects
@@ -742,11 +810,7 @@ void DrawScaleds (void)
 			if (!obj->viewheight)
 				continue;                                               // too close or far away
 
-			visptr->actor = obj;
-			visptr->viewheight = obj->viewheight;
-
-			if (visptr < &vislist[MAXVISABLE-1])    // don't let it overflow
-				visptr++;
+			AddVisSprite (obj);
 
 			obj->flags |= FL_VISABLE;
 			continue;
@@ -766,44 +830,57 @@ void DrawScaleds (void)
 		//
 		// could be in any of the nine surrounding tiles
 		//
-		if (spot->visible
-			|| ( spots[0] && (spots[0]->visible && !spots[0]->tile) )
-			|| ( spots[1] && (spots[1]->visible && !spots[1]->tile) )
-			|| ( spots[2] && (spots[2]->visible && !spots[2]->tile) )
-			|| ( spots[3] && (spots[3]->visible && !spots[3]->tile) )
-			|| ( spots[4] && (spots[4]->visible && !spots[4]->tile) )
-			|| ( spots[5] && (spots[5]->visible && !spots[5]->tile) )
-			|| ( spots[6] && (spots[6]->visible && !spots[6]->tile) )
-			|| ( spots[7] && (spots[7]->visible && !spots[7]->tile) ) )
+		if (spot->IsVisible()
+			|| ( spots[0] && (spots[0]->Flags() & (SPOT_Visible|SPOT_Tile)) == SPOT_Visible )
+			|| ( spots[1] && (spots[1]->Flags() & (SPOT_Visible|SPOT_Tile)) == SPOT_Visible )
+			|| ( spots[2] && (spots[2]->Flags() & (SPOT_Visible|SPOT_Tile)) == SPOT_Visible )
+			|| ( spots[3] && (spots[3]->Flags() & (SPOT_Visible|SPOT_Tile)) == SPOT_Visible )
+			|| ( spots[4] && (spots[4]->Flags() & (SPOT_Visible|SPOT_Tile)) == SPOT_Visible )
+			|| ( spots[5] && (spots[5]->Flags() & (SPOT_Visible|SPOT_Tile)) == SPOT_Visible )
+			|| ( spots[6] && (spots[6]->Flags() & (SPOT_Visible|SPOT_Tile)) == SPOT_Visible )
+			|| ( spots[7] && (spots[7]->Flags() & (SPOT_Visible|SPOT_Tile)) == SPOT_Visible ) )
 		{
 			TransformActor (obj);
 			if (!obj->viewheight || (gamestate.victoryflag && obj == players[ConsolePlayer].mo))
 				continue;                                               // too close or far away
 
-			visptr->actor = obj;
-			visptr->viewheight = obj->viewheight;
-
-			if (visptr < &vislist[MAXVISABLE-1])    // don't let it overflow
-				visptr++;
+			AddVisSprite (obj);
 
 			obj->flags |= FL_VISABLE;
 		}
 		else
 			obj->flags &= ~FL_VISABLE;
 	}
+}
+
+/*
+=====================
+=
+= DrawScaleds
+=
+= Draws all objects that are visable
+=
+=====================
+*/
+
+void DrawScaleds (void)
+{
+	int      i,least,numvisable,height;
+	R_VisSprite *visstep,*farthest = NULL;
 
 //
 // draw from back to front
 //
-	numvisable = (int) (visptr-&vislist[0]);
+	numvisable = (int) snapshot.sprites.Size();
 
 	if (!numvisable)
 		return;                                                                 // no visable objects
 
+	R_VisSprite * const visend = &snapshot.sprites[0] + numvisable;
 	for (i = 0; i<numvisable; i++)
 	{
 		least = 32000;
-		for (visstep=&vislist[0] ; visstep<visptr ; visstep++)
+		for (visstep=&snapshot.sprites[0] ; visstep<visend ; visstep++)
 		{
 			height = visstep->viewheight;
 			if (height < least)
@@ -815,10 +892,10 @@ void DrawScaleds (void)
 		//
 		// draw farthest
 		//
-		if(farthest->actor->flags & FL_BILLBOARD)
-			Scale3DSprite(farthest->actor, farthest->actor->state, farthest->viewheight);
+		if(farthest->billboard)
+			Scale3DSprite(*farthest, farthest->frame, farthest->viewheight);
 		else
-			ScaleSprite(farthest->actor, farthest->actor->viewx, farthest->actor->state, farthest->viewheight);
+			ScaleSprite(*farthest, farthest->viewx, farthest->frame, farthest->viewheight);
 
 		farthest->viewheight = 32000;
 	}
@@ -836,20 +913,34 @@ void DrawScaleds (void)
 ==============
 */
 
-void DrawPlayerWeapon (void)
+void CollectPlayerWeapon (void)
 {
+	player_t &player = players[ConsolePlayer];
+
+	snapshot.numpsprites = 0;
 	for(unsigned int i = 0;i < player_t::NUM_PSPRITES;++i)
 	{
-		if(!players[ConsolePlayer].psprite[i].frame)
+		if(!player.psprite[i].frame)
 			return;
 
 		fixed xoffset, yoffset;
-		players[ConsolePlayer].BobWeapon(&xoffset, &yoffset);
-
-		R_DrawPlayerSprite(players[ConsolePlayer].ReadyWeapon, players[ConsolePlayer].psprite[i].frame, players[ConsolePlayer].psprite[i].sx+xoffset, players[ConsolePlayer].psprite[i].sy+yoffset);
+		player.BobWeapon(&xoffset, &yoffset);
+
+		R_PlayerSprite &psprite = snapshot.psprites[snapshot.numpsprites++];
+		psprite.frame = player.psprite[i].frame;
+		psprite.offsetX = player.psprite[i].sx+xoffset;
+		psprite.offsetY = player.psprite[i].sy+yoffset;
+		psprite.rotation = player.ReadyWeapon ? CalcRotate(player.ReadyWeapon) : 0;
+		psprite.yadjust = player.ReadyWeapon ? player.ReadyWeapon->yadjust : 0;
 	}
 }
 
+void DrawPlayerWeapon (void)
+{
+	for(unsigned int i = 0;i < snapshot.numpsprites;++i)
+		R_DrawPlayerSprite(snapshot.psprites[i]);
+}
+
 //==========================================================================
 
 void AsmRefresh()
@@ -860,6 +951,10 @@ void AsmRefresh()
 	MapSpot focalspot = map->GetSpot(focaltx, focalty, 0);
 	bool playerInPushwallBackTile = focalspot->pushAmount != 0;
 
+	// The DDA walks the compact flags and only touches the full spot on a hit
+	BYTE * const planeflags = map->GetPlane(0).spotFlags;
+	BYTE *spotflags;
+
 	if(gameinfo.walldecalcolor >= 256)
 		postdecalcolor = (byte)(gameinfo.walldecalcolor&0xff);
 
@@ -976,9 +1071,10 @@ vertentry:
 			}
 			if(xspot[0]>=mapwidth || xspot[1]>=mapheight) break;
 			tilehit=map->GetSpot(xspot[0], xspot[1], 0);
-			if(tilehit && tilehit->tile)
+			spotflags=&planeflags[xspot[1]*mapwidth+xspot[0]];
+			if(*spotflags & SPOT_Tile)
 			{
-				if(tilehit->tile->offsetVertical)
+				if(*spotflags & SPOT_DoorVertical)
 				{
 					DetermineHitDir(true);
 					int32_t yintbuf=yintercept+(ystep>>1);
@@ -993,7 +1089,7 @@ vertentry:
 				}
 				else
 				{
-					bool isPushwall = tilehit->pushAmount != 0 || tilehit->pushReceptor;
+					bool isPushwall = (*spotflags & SPOT_Pushwall) != 0;
 					if(tilehit->pushReceptor)
 						tilehit = tilehit->pushReceptor;
 
@@ -1113,8 +1209,12 @@ vertentry:
 				break;
 			}
 passvert:
-			tilehit->visible=true;
-			tilehit->amFlags |= AM_Visible;
+			*spotflags |= SPOT_Visible;
+			if(!(*spotflags & SPOT_Mapped))
+			{
+				tilehit->SetMapped();
+				*spotflags |= SPOT_Mapped;
+			}
 			xtile+=xtilestep;
 			yintercept+=ystep;
 			xspot[0]=xtile;
@@ -1143,9 +1243,10 @@ horizentry:
 			}
 			if(yspot[0]>=mapwidth || yspot[1]>=mapheight) break;
 			tilehit=map->GetSpot(yspot[0], yspot[1], 0);
-			if(tilehit && tilehit->tile)
+			spotflags=&planeflags[yspot[1]*mapwidth+yspot[0]];
+			if(*spotflags & SPOT_Tile)
 			{
-				if(tilehit->tile->offsetHorizontal)
+				if(*spotflags & SPOT_DoorHorizontal)
 				{
 					DetermineHitDir(false);
 					int32_t xintbuf=xintercept+(xstep>>1);
@@ -1160,7 +1261,7 @@ horizentry:
 				}
 				else
 				{
-					bool isPushwall = tilehit->pushAmount != 0 || tilehit->pushReceptor;
+					bool isPushwall = (*spotflags & SPOT_Pushwall) != 0;
 					if(tilehit->pushReceptor)
 						tilehit = tilehit->pushReceptor;
 
@@ -1280,8 +1381,12 @@ horizentry:
 				break;
 			}
 passhoriz:
-			tilehit->visible=true;
-			tilehit->amFlags |= AM_Visible;
+			*spotflags |= SPOT_Visible;
+			if(!(*spotflags & SPOT_Mapped))
+			{
+				tilehit->SetMapped();
+				*spotflags |= SPOT_Mapped;
+			}
 			ytile+=ytilestep;
 			xintercept+=xstep;
 			yspot[0]=xintercept>>16;
@@ -1348,8 +1453,11 @@ void CalcViewVariables()
 
 //==========================================================================
 
-void R_RenderView()
+// Everything that needs to look at the live game state: the walls are cast
+// against the map and the snapshot is filled in.
+static void R_RenderViewFront()
 {
+	TexMan.UpdateWarpTextures();
 	CalcViewVariables();
 
 //
@@ -1366,10 +1474,22 @@ void R_RenderView()
 		DrawParallax(vbuf, vbufPitch);
 	}
 
+	Shading::SnapshotMap ();
 	Shading::PopulateHalos ();
 
 	WallRefresh ();
 
+	CollectScaleds ();
+	CollectPlayerWeapon ();
+
+	// Always mark the current spot as visible in the automap
+	map->GetSpot(players[ConsolePlayer].mo->tilex, players[ConsolePlayer].mo->tiley, 0)->SetMapped();
+}
+
+// Everything drawn from here on only uses the view variables and the
+// snapshot, so it may run on the render thread.
+static void R_RenderViewTail()
+{
 	if (!levelInfo->ParallaxDecals && levelInfo->ParallaxSky.Size() > 0)
 		DrawParallax(vbuf, vbufPitch);
 #if defined(USE_FEATUREFLAGS) && defined(USE_CLOUDSKY)
@@ -1389,34 +1509,114 @@ void R_RenderView()
 		DrawSnow(vbuf, vbufPitch, 0, 0);
 
 	DrawPlayerWeapon ();    // draw player's hands
+}
 
+static void R_RenderViewFinish()
+{
 	if((control[ConsolePlayer].buttonstate[bt_showstatusbar] || control[ConsolePlayer].buttonheld[bt_showstatusbar]) && viewsize == 21)
 	{
 		ingame = false;
 		StatusBar->DrawStatusBar();
 		ingame = true;
 	}
+}
 
-	// Always mark the current spot as visible in the automap
-	map->GetSpot(players[ConsolePlayer].mo->tilex, players[ConsolePlayer].mo->tiley, 0)->amFlags |= AM_Visible;
+void R_RenderView()
+{
+	R_RenderViewFront();
+	R_RenderViewTail();
+	R_RenderViewFinish();
 }
 
 /*
-========================
-=
-= ThreeDRefresh
-=
-========================
+=============================================================================
+
+						PIPELINED REFRESH
+
+ With vid_pipelined the second half of the refresh is handed to a render
+ thread and PlayLoop runs the next tics while it draws. R_SyncRefresh must be
+ called before anything else touches the screen. Locking the screen and the
+ canvas drawing functions do this, so only code writing to an already locked
+ buffer needs to call it itself.
+
+=============================================================================
 */
 
-void    ThreeDRefresh (void)
+static std::thread renderThread;
+static std::mutex renderMutex;
+static std::condition_variable renderCond;
+static bool renderPending = false;
+static bool renderQuit = false;
+static bool refreshInFlight = false;
+// The tail may draw through the screen's own functions, which would otherwise
+// try to sync with themselves.
+static thread_local bool onRenderThread = false;
+
+static void R_RenderThread()
 {
-	MapEdit::AdjustGameMap adjustGameMap;
+	onRenderThread = true;
+
+	std::unique_lock<std::mutex> lock(renderMutex);
+	while(true)
+	{
+		renderCond.wait(lock, [] { return renderPending || renderQuit; });
+		if(renderQuit)
+			break;
+
+		lock.unlock();
+		R_RenderViewTail();
+		lock.lock();
+
+		renderPending = false;
+		renderCond.notify_all();
+	}
+}
 
+static void R_StopRenderThread()
+{
+	if(!renderThread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(renderMutex);
+		renderQuit = true;
+	}
+	renderCond.notify_all();
+	renderThread.join();
+}
+
+static void R_StartRenderTail()
+{
+	if(!renderThread.joinable())
+	{
+		renderThread = std::thread(R_RenderThread);
+		atterm(R_StopRenderThread);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(renderMutex);
+		renderPending = true;
+	}
+	renderCond.notify_all();
+}
+
+static void R_WaitRenderTail()
+{
+	std::unique_lock<std::mutex> lock(renderMutex);
+	renderCond.wait(lock, [] { return !renderPending; });
+}
+
+static bool refreshFizzle;
+
+static bool BeginRefresh (void)
+{
 	// Ensure we have a valid camera
 	if(players[ConsolePlayer].camera == NULL)
 		players[ConsolePlayer].camera = players[ConsolePlayer].mo;
 
+	// Remember if this frame started the fizzle since the next tics may
+	// set fizzlein while it is being drawn.
+	refreshFizzle = fizzlein;
 	if (fizzlein && gameinfo.DeathTransition == GameInfo::TRANSITION_Fizzle)
 		FizzleFadeStart();
 
@@ -1426,12 +1626,18 @@ void    ThreeDRefresh (void)
 	map->ClearVisibility();
 
 	vbuf = VL_LockSurface();
-	if(vbuf == NULL) return;
+	if(vbuf == NULL) return false;
 
 	vbuf += screenofs;
 	vbufPitch = SCREENPITCH;
 
-	R_RenderView();
+	R_RenderViewFront();
+	return true;
+}
+
+static void FinishRefresh (void)
+{
+	R_RenderViewFinish();
 
 	VL_UnlockSurface();
 	vbuf = NULL;
@@ -1439,7 +1645,7 @@ void    ThreeDRefresh (void)
 //
 // show screen and time last cycle
 //
-	if (fizzlein)
+	if (refreshFizzle)
 	{
 		if(gameinfo.DeathTransition == GameInfo::TRANSITION_Fizzle)
 			FizzleFade(0, 0, screenWidth, screenHeight, 20, false);
@@ -1484,3 +1690,64 @@ void    ThreeDRefresh (void)
 	if (gameinfo.DrawGameMessage)
 		DrawGameMessage ();
 }
+
+/*
+========================
+=
+= ThreeDRefresh
+=
+========================
+*/
+
+void    ThreeDRefresh (void)
+{
+	R_SyncRefresh();
+
+	MapEdit::AdjustGameMap adjustGameMap;
+
+	if(!BeginRefresh())
+		return;
+	R_RenderViewTail();
+	FinishRefresh();
+}
+
+/*
+========================
+=
+= ThreeDRefreshBegin
+=
+= Like ThreeDRefresh, but the floors, sprites and weapon are drawn on the
+= render thread. The frame is completed by R_SyncRefresh.
+=
+========================
+*/
+
+void    ThreeDRefreshBegin (void)
+{
+	// The map editor marker temporarily edits the map, so it can't overlap
+	// with the game tics.
+	if(me_marker)
+	{
+		ThreeDRefresh();
+		return;
+	}
+
+	R_SyncRefresh();
+
+	if(!BeginRefresh())
+		return;
+
+	refreshInFlight = true;
+	R_StartRenderTail();
+}
+
+void    R_SyncRefresh (void)
+{
+	if(onRenderThread || !refreshInFlight)
+		return;
+
+	// Clear first since finishing the frame may update the screen.
+	refreshInFlight = false;
+	R_WaitRenderTail();
+	FinishRefresh();
+}
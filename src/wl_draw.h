@@ -37,6 +37,8 @@ extern  fixed   viewx,viewy;                    // the focal point
 extern  fixed   viewsin,viewcos;
 
 void    ThreeDRefresh (void);
+void    ThreeDRefreshBegin (void);
+void    R_SyncRefresh (void);
 int     WallMidY (int ywcount, int bot);
 int     InvWallMidY(int y, int bot);
 
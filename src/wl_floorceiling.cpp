@@ -48,29 +48,259 @@ namespace Shading
 			C(C_), R(R_), light(light_), littype(littype_)
 		{
 		}
+
+		bool operator== (const Halo &other) const
+		{
+			return C == other.C && R == other.R && light == other.light && littype == other.littype;
+		}
+
+		bool operator!= (const Halo &other) const
+		{
+			return !(*this == other);
+		}
+
+		// Returns true if every point in the tile at (x, y) is lit.
+		bool CoversTile (int x, int y) const
+		{
+			const double dx = std::max(fabs(C.X - x), fabs(C.X - (x+1)));
+			const double dy = std::max(fabs(C.Y - y), fabs(C.Y - (y+1)));
+			return dx*dx + dy*dy <= R*R;
+		}
 	};
 
 	class Tile
 	{
 	public:
 		typedef std::pair<int, int> Pos;
+		// All halos touching the tile.
 		std::vector<Halo::Id> haloIds;
+		// Halos which only light part of the tile. The light from halos
+		// covering the entire tile is summed in bakedLight.
+		std::vector<Halo::Id> partialIds;
+		int bakedLight = 0;
 	};
 
+	// What the floors, sprites and weather need to know about a spot. These
+	// are copied from the map by SnapshotMap on the main thread so that the
+	// second half of the refresh never reads the map while the next tics run.
+	class Spot
+	{
+	public:
+		// Zone and light sector are INT_MAX if the spot has none.
+		struct Light
+		{
+			unsigned int zone;
+			unsigned int lightsector;
+			int light;
+		};
+
+		FTextureID texture[2];
+		// Doors are lit from whichever side of them is visible, so both
+		// sides are kept. Every other spot only uses light[0].
+		Light light[2];
+		bool door;
+		MapTile::Side doordir;
+	};
+
+	std::vector<Spot> spots;
+	unsigned int spotsWidth;
+	unsigned int spotsHeight;
+	unsigned int ceilingDepth;
+
 	int halfheight;
 	fixed planeheight;
 	std::vector<Span> spans;
 	Span *curspan;
+	// Halos keep their id for as long as the light they come from is on, so
+	// the tiles only have to be relinked when a light moves or changes.
 	std::vector<Halo> halos;
+	typedef std::pair<const AActor *, int> HaloKey; // Actor and halo light id
+	std::map<HaloKey, Halo::Id> haloSlots;
+	std::vector<Halo::Id> freeHaloIds;
+	std::vector<unsigned int> haloSeen; // Last haloFrame each id was found in
+	unsigned int haloFrame = 0;
 	std::vector<Tile> tiles;
+	unsigned int tilesWidth;
 	Halo::Id lastHaloId;
 	std::vector<byte> rowHaloIds;
 	typedef unsigned short ZoneId;
 	std::map<ZoneId, AActor::ZoneLight> zoneLightMap;
 
+	// Adds or removes the halo from the light field of the tiles it touches.
+	void LinkHalo (const Halo &h, Halo::Id haloId, bool link)
+	{
+		const unsigned int mapwidth = map->GetHeader().width;
+
+		TVector2<int> low, high;
+		(h.C - h.R).Convert(low);
+		(h.C + h.R).Convert(high);
+
+		int x;
+		for (x = low.X; x <= high.X; x++)
+		{
+			int y;
+			for (y = low.Y; y <= high.Y; y++)
+			{
+				if (!map->IsValidTileCoordinate(x,y,0))
+					continue;
+
+				Tile &tile = tiles[x+y*mapwidth];
+				const bool covers = h.CoversTile(x, y);
+				if (link)
+				{
+					tile.haloIds.push_back(haloId);
+					if (covers)
+						tile.bakedLight += h.light;
+					else
+						tile.partialIds.push_back(haloId);
+				}
+				else
+				{
+					tile.haloIds.erase(std::find(tile.haloIds.begin(), tile.haloIds.end(), haloId));
+					if (covers)
+						tile.bakedLight -= h.light;
+					else
+						tile.partialIds.erase(std::find(tile.partialIds.begin(), tile.partialIds.end(), haloId));
+				}
+			}
+		}
+	}
+
+	static void SnapshotLight (Spot::Light &light, MapSpot spot)
+	{
+		light.zone = spot && spot->zone ? spot->zone->index : INT_MAX;
+		if (spot && spot->lightsector)
+		{
+			light.lightsector = spot->lightsector->index;
+			light.light = spot->lightsector->light;
+		}
+		else
+		{
+			light.lightsector = INT_MAX;
+			light.light = 0;
+		}
+	}
+
+	static void SnapshotSpot (unsigned int x, unsigned int y)
+	{
+		const MapSpot spot = map->GetSpot(x, y, 0);
+		Spot &snap = spots[x+y*spotsWidth];
+
+		if (spot->sector)
+		{
+			snap.texture[MapSector::Floor] = spot->sector->texture[MapSector::Floor];
+			snap.texture[MapSector::Ceiling] = spot->sector->texture[MapSector::Ceiling];
+		}
+		else
+		{
+			snap.texture[MapSector::Floor].SetInvalid();
+			snap.texture[MapSector::Ceiling].SetInvalid();
+		}
+
+		snap.door = false;
+		snap.doordir = MapTile::East;
+		if (spot->tile)
+		{
+			if (spot->tile->offsetVertical && !spot->tile->offsetHorizontal)
+			{
+				snap.door = true;
+				snap.doordir = MapTile::East;
+			}
+			else if (spot->tile->offsetHorizontal && !spot->tile->offsetVertical)
+			{
+				snap.door = true;
+				snap.doordir = MapTile::South;
+			}
+		}
+
+		if (snap.door)
+		{
+			SnapshotLight(snap.light[0], spot->GetAdjacent(snap.doordir, false));
+			SnapshotLight(snap.light[1], spot->GetAdjacent(snap.doordir, true));
+		}
+		else
+			SnapshotLight(snap.light[0], spot);
+	}
+
+	// The whole map is only copied when a new one is loaded. After that just
+	// the spots the map reports as changed are taken again, along with their
+	// neighbours since a door is lit from the spots on either side of it.
+	void SnapshotMap (void)
+	{
+		static TArray<unsigned int> changed;
+		if (!map->TakeChangedSpots(changed) || spots.size() != map->GetHeader().width*map->GetHeader().height)
+		{
+			spotsWidth = map->GetHeader().width;
+			spotsHeight = map->GetHeader().height;
+			ceilingDepth = map->GetPlane(0).depth;
+			spots.resize(spotsWidth*spotsHeight);
+
+			for (unsigned int y = 0; y < spotsHeight; y++)
+			{
+				for (unsigned int x = 0; x < spotsWidth; x++)
+					SnapshotSpot(x, y);
+			}
+			return;
+		}
+
+		for (unsigned int i = 0; i < changed.Size(); i++)
+		{
+			const unsigned int x = changed[i]%spotsWidth;
+			const unsigned int y = changed[i]/spotsWidth;
+			SnapshotSpot(x, y);
+			if (x > 0)
+				SnapshotSpot(x-1, y);
+			if (x+1 < spotsWidth)
+				SnapshotSpot(x+1, y);
+			if (y > 0)
+				SnapshotSpot(x, y-1);
+			if (y+1 < spotsHeight)
+				SnapshotSpot(x, y+1);
+		}
+	}
+
+	bool HasCeiling (unsigned int x, unsigned int y)
+	{
+		return spots[(x%spotsWidth)+(y%spotsHeight)*spotsWidth].texture[MapSector::Ceiling].isValid();
+	}
+
+	// Links a halo found this frame, reusing the id it had last frame.
+	void UpdateHalo (const HaloKey &key, const Halo &h)
+	{
+		std::map<HaloKey, Halo::Id>::iterator slot = haloSlots.find(key);
+		if (slot != haloSlots.end())
+		{
+			const Halo::Id haloId = slot->second;
+			haloSeen[haloId] = haloFrame;
+			if (halos[haloId] != h)
+			{
+				LinkHalo(halos[haloId], haloId, false);
+				halos[haloId] = h;
+				LinkHalo(h, haloId, true);
+			}
+			return;
+		}
+
+		Halo::Id haloId;
+		if (!freeHaloIds.empty())
+		{
+			haloId = freeHaloIds.back();
+			freeHaloIds.pop_back();
+			halos[haloId] = h;
+		}
+		else
+		{
+			haloId = halos.size();
+			halos.push_back(h);
+			haloSeen.push_back(0);
+		}
+		haloSeen[haloId] = haloFrame;
+		haloSlots[key] = haloId;
+		LinkHalo(h, haloId, true);
+	}
+
 	void PopulateHalos (void)
 	{
-		halos.clear();
 		zoneLightMap.clear();
 		//halos.push_back(Halo(TVector2<double>(49.5, 146.5), 0.5, 10<<3));
 		//halos.push_back(Halo(TVector2<double>(49.5, 146.5), 1.0, 5<<3));
@@ -78,6 +308,18 @@ namespace Shading
 		const unsigned int mapwidth = map->GetHeader().width;
 		const unsigned int mapheight = map->GetHeader().height;
 
+		const auto numtiles = mapwidth * mapheight;
+		if (numtiles != tiles.size() || mapwidth != tilesWidth)
+		{
+			tiles.assign(numtiles, Tile{});
+			tilesWidth = mapwidth;
+			halos.clear();
+			haloSlots.clear();
+			freeHaloIds.clear();
+			haloSeen.clear();
+		}
+		++haloFrame;
+
 		for(AActor::Iterator check = AActor::GetIterator();check.Next();)
 		{
 			{
@@ -96,7 +338,7 @@ namespace Shading
 							{
 								const double x = FIXED2FLOAT(check->x);
 								const double y = FIXED2FLOAT(check->y);
-								halos.push_back(Halo(TVector2<double>(x, y), haloLight->radius, haloLight->light<<3, haloLight->littype));
+								UpdateHalo(HaloKey(check, haloLight->id), Halo(TVector2<double>(x, y), haloLight->radius, haloLight->light<<3, haloLight->littype));
 							}
 						}
 					}
@@ -138,43 +380,25 @@ namespace Shading
 			}
 		}
 
-		const auto numtiles = mapwidth * mapheight;
-		if (numtiles != tiles.size())
+		// Unlink the halos whose light went away. Their ids are left unused
+		// until another light comes on, so nothing else has to move.
+		std::map<HaloKey, Halo::Id>::iterator slot = haloSlots.begin();
+		while (slot != haloSlots.end())
 		{
-			tiles.resize(numtiles);
-		}
-		std::fill(std::begin(tiles), std::end(tiles), Tile{});
-
-		lastHaloId = 0;
-		{
-			typedef std::vector<Halo> HaloVec;
-			const HaloVec &v = halos;
-			for (HaloVec::const_iterator it = v.begin(); it != v.end(); ++it)
+			const Halo::Id haloId = slot->second;
+			if (haloSeen[haloId] == haloFrame)
 			{
-				const Halo &h = *it;
-				TVector2<int> low, high;
-				(h.C - h.R).Convert(low);
-				(h.C + h.R).Convert(high);
-
-				const auto haloId = it - v.begin();
-
-				int x;
-				for (x = low.X; x <= high.X; x++)
-				{
-					int y;
-					for (y = low.Y; y <= high.Y; y++)
-					{
-						if (map->IsValidTileCoordinate(x,y,0))
-						{
-							tiles[x+y*mapwidth].haloIds.push_back(haloId);
-							lastHaloId = std::max(lastHaloId,
-									static_cast<Halo::Id>(haloId + 1));
-						}
-					}
-				}
+				++slot;
+				continue;
 			}
+
+			LinkHalo(halos[haloId], haloId, false);
+			freeHaloIds.push_back(haloId);
+			haloSlots.erase(slot++);
 		}
-		rowHaloIds = std::vector<byte>((lastHaloId+7)/8);
+
+		lastHaloId = halos.size();
+		rowHaloIds.resize((lastHaloId+7)/8);
 	}
 
 	void PrepareConstants (int halfheight_, fixed planeheight_)
@@ -256,8 +480,8 @@ namespace Shading
 		spans.clear();
 		spans.push_back(Span(vw, 0, NULL));
 
-		const unsigned int mapwidth = map->GetHeader().width;
-		const unsigned int mapheight = map->GetHeader().height;
+		const unsigned int mapwidth = spotsWidth;
+		const unsigned int mapheight = spotsHeight;
 
 		std::memset(rowHaloIds.data(), 0, rowHaloIds.size());
 		{
@@ -269,12 +493,11 @@ namespace Shading
 			int zonex = -1;
 			unsigned int curzone = INT_MAX;
 			unsigned int oldlightsector = INT_MAX;
-			const MapLightSector* p_oldlightsector = NULL;
+			int oldlight = 0;
 			int lightsectorx = -1;
 			unsigned int curlightsector = INT_MAX;
-			const MapLightSector* p_curlightsector = NULL;
-			MapTile::Side doordir = MapTile::East;
-			MapSpot doorspot = NULL;
+			int curlight = 0;
+			const Spot *doorspot = NULL;
 			for (int x = lx; x < rx; x++)
 			{
 				if(y >= wallheight[x][botind]>>3)
@@ -298,58 +521,35 @@ namespace Shading
 							rowHaloIds[id/8] |= 1<<(id&7);
 						}
 
-						MapSpot spot = map->GetSpot(mapx, mapy, 0);
-						if (spot)
+						const Spot &spot = spots[mapx+mapy*mapwidth];
+						const Spot::Light *light = &spot.light[0];
+						if (spot.door)
 						{
-							if (spot->tile)
-							{
-								if (spot->tile->offsetVertical && !spot->tile->offsetHorizontal)
-								{
-									doorspot = spot;
-									doordir = MapTile::East;
-									oldmapxdoor = gu >> (TILESHIFT-1);
-									spot = doorspot->GetAdjacent(doordir, !(oldmapxdoor&1));
-								}
-								else if (spot->tile->offsetHorizontal && !spot->tile->offsetVertical)
-								{
-									doorspot = spot;
-									doordir = MapTile::South;
-									oldmapxdoor = gv >> (TILESHIFT-1);
-									spot = doorspot->GetAdjacent(doordir, !(oldmapxdoor&1));
-								}
-								if (spot && spot->zone != NULL)
-									curzone = spot->zone->index;
-								if (spot && spot->lightsector != NULL)
-								{
-									curlightsector = spot->lightsector->index;
-									p_curlightsector = spot->lightsector;
-								}
-							}
-							else
-							{
-								if (spot->zone != NULL)
-									curzone = spot->zone->index;
-								if (spot->lightsector != NULL)
-								{
-									curlightsector = spot->lightsector->index;
-									p_curlightsector = spot->lightsector;
-								}
-							}
+							doorspot = &spot;
+							oldmapxdoor = (spot.doordir==MapTile::South ? gv:gu) >> (TILESHIFT-1);
+							light = &spot.light[!(oldmapxdoor&1)];
+						}
+						if (light->zone != INT_MAX)
+							curzone = light->zone;
+						if (light->lightsector != INT_MAX)
+						{
+							curlightsector = light->lightsector;
+							curlight = light->light;
 						}
 					}
 
 					if (oldmapxdoor != INT_MAX)
 					{
-						unsigned int curxdoor = ((doordir==MapTile::South ? gv:gu) >> (TILESHIFT-1));
+						unsigned int curxdoor = ((doorspot->doordir==MapTile::South ? gv:gu) >> (TILESHIFT-1));
 						if (curxdoor != oldmapxdoor)
 						{
-							MapSpot spot = doorspot->GetAdjacent(doordir, !(curxdoor&1));
-							if (spot && spot->zone != NULL)
-								curzone = spot->zone->index;
-							if (spot && spot->lightsector != NULL)
+							const Spot::Light &light = doorspot->light[!(curxdoor&1)];
+							if (light.zone != INT_MAX)
+								curzone = light.zone;
+							if (light.lightsector != INT_MAX)
 							{
-								curlightsector = spot->lightsector->index;
-								p_curlightsector = spot->lightsector;
+								curlightsector = light.lightsector;
+								curlight = light.light;
 							}
 							oldmapxdoor = INT_MAX;
 						}
@@ -359,18 +559,16 @@ namespace Shading
 				{
 					curzone = INT_MAX;
 					curlightsector = INT_MAX;
-					p_curlightsector = NULL;
 				}
 
 				if (curlightsector != oldlightsector)
 				{
-					if (lightsectorx > -1 && oldlightsector != INT_MAX &&
-						p_oldlightsector != NULL)
+					if (lightsectorx > -1 && oldlightsector != INT_MAX)
 					{
-						InsertSpan (lightsectorx-lx, x-lx, spans, p_oldlightsector->light, NULL);
+						InsertSpan (lightsectorx-lx, x-lx, spans, oldlight, NULL);
 					}
 					oldlightsector = curlightsector;
-					p_oldlightsector = p_curlightsector;
+					oldlight = curlight;
 					lightsectorx = x;
 				}
 				if (curzone != oldzone)
@@ -390,10 +588,9 @@ namespace Shading
 				gv += dv;
 			}
 
-			if (lightsectorx > -1 && INT_MAX != oldlightsector && lightsectorx<rx &&
-				p_oldlightsector != NULL)
+			if (lightsectorx > -1 && INT_MAX != oldlightsector && lightsectorx<rx)
 			{
-				InsertSpan (lightsectorx, rx, spans, p_oldlightsector->light, NULL);
+				InsertSpan (lightsectorx, rx, spans, oldlight, NULL);
 			}
 			if (zonex > -1 && INT_MAX != oldzone && zonex<rx &&
 				zoneLightMap.find((ZoneId)oldzone) != zoneLightMap.end())
@@ -491,12 +688,17 @@ namespace Shading
 		curx = xintercept>>TILESHIFT;
 		cury = yintercept>>TILESHIFT;
 
-		const unsigned int mapwidth = map->GetHeader().width;
-		const unsigned int mapheight = map->GetHeader().height;
+		const unsigned int mapwidth = spotsWidth;
+		const unsigned int mapheight = spotsHeight;
+
+		const Tile &tile = tiles[(curx%mapwidth)+(cury%mapheight)*mapwidth];
 
-		int light = 0;
+		// Halos covering the whole tile are baked in to the light field, but
+		// that only holds if the intercept is actually in the tile.
+		const bool inmap = curx < mapwidth && cury < mapheight;
+		int light = inmap ? tile.bakedLight : 0;
 		typedef std::vector<Halo::Id> Vec;
-		const Vec &v = tiles[(curx%mapwidth)+(cury%mapheight)*mapwidth].haloIds;
+		const Vec &v = inmap ? tile.partialIds : tile.haloIds;
 		if (v.size() > 0)
 		{
 			const double x = FIXED2FLOAT(xintercept);
@@ -517,35 +719,20 @@ namespace Shading
 			}
 		}
 
-		MapSpot spot = map->GetSpot(curx%mapwidth, cury%mapheight, 0);
-		if (spot->tile)
+		const Spot &spot = spots[(curx%mapwidth)+(cury%mapheight)*mapwidth];
+		const Spot::Light *spotlight = &spot.light[0];
+		if (spot.door)
 		{
-			unsigned int oldmapxdoor;
-			MapTile::Side doordir;
-			MapSpot doorspot;
-
-			if (spot->tile->offsetVertical && !spot->tile->offsetHorizontal)
-			{
-				doorspot = spot;
-				doordir = MapTile::East;
-				oldmapxdoor = xintercept >> (TILESHIFT-1);
-				spot = doorspot->GetAdjacent(doordir, !(oldmapxdoor&1));
-			}
-			else if (spot->tile->offsetHorizontal && !spot->tile->offsetVertical)
-			{
-				doorspot = spot;
-				doordir = MapTile::South;
-				oldmapxdoor = yintercept >> (TILESHIFT-1);
-				spot = doorspot->GetAdjacent(doordir, !(oldmapxdoor&1));
-			}
+			const unsigned int mapxdoor = (spot.doordir==MapTile::South ? yintercept : xintercept) >> (TILESHIFT-1);
+			spotlight = &spot.light[!(mapxdoor&1)];
 		}
-		if (spot && spot->zone != NULL &&
-				zoneLightMap.find(spot->zone->index) != zoneLightMap.end())
+		if (spotlight->zone != INT_MAX &&
+				zoneLightMap.find((ZoneId)spotlight->zone) != zoneLightMap.end())
 		{
-			light += zoneLightMap.find(spot->zone->index)->second.light;
+			light += zoneLightMap.find((ZoneId)spotlight->zone)->second.light;
 		}
-		if (spot && spot->lightsector != NULL)
-			light += spot->lightsector->light;
+		if (spotlight->lightsector != INT_MAX)
+			light += spotlight->light;
 
 		return light;
 	}
@@ -567,14 +754,15 @@ static void R_DrawPlane(byte *vbuf, unsigned vbufPitch, TWallHeight min_wallheig
 	FTextureID lasttex;
 	byte *tex_offset;
 	bool useOptimized = false;
+	int miplevel = 0;
 
 	if(planeheight == 0) // Eye level
 		return;
 	
 	TWallHeight y0{{min_wallheight[0]>>3,min_wallheight[1]>>3,min_wallheight[2]>>3}};
 
-	const unsigned int mapwidth = map->GetHeader().width;
-	const unsigned int mapheight = map->GetHeader().height;
+	const unsigned int mapwidth = Shading::spotsWidth;
+	const unsigned int mapheight = Shading::spotsHeight;
 
 	fixed planenumerator = FixedMul(heightnumerator, planeheight);
 	const bool floor = planenumerator < 0;
@@ -644,30 +832,37 @@ static void R_DrawPlane(byte *vbuf, unsigned vbufPitch, TWallHeight min_wallheig
 				{
 					oldmapx = curx;
 					oldmapy = cury;
-					const MapSpot spot = map->GetSpot(oldmapx%mapwidth, oldmapy%mapheight, 0);
+					const Shading::Spot &spot = Shading::spots[(oldmapx%mapwidth)+(oldmapy%mapheight)*mapwidth];
 
-					if(spot->sector)
+					FTextureID curtex = spot.texture[floor ? MapSector::Floor : MapSector::Ceiling];
+					if (curtex.isValid())
 					{
-						FTextureID curtex = spot->sector->texture[floor ? MapSector::Floor : MapSector::Ceiling];
-						if (curtex.isValid())
+						if(curtex != lasttex)
 						{
-							if(curtex != lasttex)
+							FTexture * const texture = TexMan(curtex);
+							lasttex = curtex;
+							texwidth = texture->GetWidth();
+							texheight = texture->GetHeight();
+							texxscale = texture->xScale>>10;
+							texyscale = -texture->yScale>>10;
+
+							useOptimized = texwidth == 64 && texheight == 64 && texxscale == FRACUNIT>>10 && texyscale == -FRACUNIT>>10;
+
+							// Rows far enough out to skip texels read from the
+							// mip level that brings the step back under two.
+							// Filtering would smear the transparent color, so
+							// keyed planes always use the full texture.
+							miplevel = 0;
+							if(vid_mipmaps && !trans.first)
 							{
-								FTexture * const texture = TexMan(curtex);
-								lasttex = curtex;
-								tex = texture->GetPixels();
-								texwidth = texture->GetWidth();
-								texheight = texture->GetHeight();
-								texxscale = texture->xScale>>10;
-								texyscale = -texture->yScale>>10;
-
-								useOptimized = texwidth == 64 && texheight == 64 && texxscale == FRACUNIT>>10 && texyscale == -FRACUNIT>>10;
+								const int levels = texture->GetMipLevels();
+								const int64_t texelstep = (int64_t)tex_step * texxscale;
+								while(miplevel < levels && texelstep >= (int64_t(2)<<24)<<miplevel)
+									++miplevel;
 							}
-						}
-						else
-						{
-							tex = NULL;
-							lasttex.SetInvalid();
+							tex = texture->GetMipmap(miplevel);
+							texwidth >>= miplevel;
+							texheight >>= miplevel;
 						}
 					}
 					else
@@ -681,7 +876,7 @@ static void R_DrawPlane(byte *vbuf, unsigned vbufPitch, TWallHeight min_wallheig
 
 				if(tex)
 				{
-					if(useOptimized)
+					if(useOptimized && miplevel == 0)
 					{
 						const int u = (gu>>18) & 63;
 						const int v = (-gv>>18) & 63;
@@ -691,8 +886,8 @@ static void R_DrawPlane(byte *vbuf, unsigned vbufPitch, TWallHeight min_wallheig
 					}
 					else
 					{
-						const int u = (FixedMul((viewxTile<<16)+(gu>>8)-512, texxscale)) & (texwidth-1);
-						const int v = (FixedMul((viewyTile<<16)+(gv>>8)+512, texyscale)) & (texheight-1);
+						const int u = (FixedMul((viewxTile<<16)+(gu>>8)-512, texxscale)>>miplevel) & (texwidth-1);
+						const int v = (FixedMul((viewyTile<<16)+(gv>>8)+512, texyscale)>>miplevel) & (texheight-1);
 						const unsigned texoffs = (u * texheight) + v;
 						if (!R_PixIsTrans(tex[texoffs], trans))
 							*tex_offset = curshades[tex[texoffs]];
@@ -726,5 +921,5 @@ void DrawFloorAndCeiling(byte *vbuf, unsigned vbufPitch, TWallHeight min_wallhei
 	std::pair<bool, byte> ceiltrans(numParallax > 0, skyceilcol);
 
 	R_DrawPlane(vbuf, vbufPitch, min_wallheight, halfheight, viewz, floortrans);
-	R_DrawPlane(vbuf, vbufPitch, min_wallheight, halfheight, viewz+(map->GetPlane(0).depth<<FRACBITS), ceiltrans);
+	R_DrawPlane(vbuf, vbufPitch, min_wallheight, halfheight, viewz+(Shading::ceilingDepth<<FRACBITS), ceiltrans);
 }
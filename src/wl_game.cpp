@@ -7,6 +7,7 @@
 #endif
 
 #include <algorithm>
+#include <climits>
 #include <math.h>
 #include "wl_def.h"
 #include "wl_menu.h"
@@ -214,7 +215,7 @@ SetSoundLoc(fixed gx,fixed gy,double attenuation)
 =
 ==========================
 */
-void PlaySoundLocGlobal(const char* s,fixed gx,fixed gy,int chan,unsigned int objId,bool looped,double attenuation, double volume)
+void PlaySoundLocGlobal(const SoundIndex &s,fixed gx,fixed gy,int chan,unsigned int objId,bool looped,double attenuation, double volume)
 {
 	if (looped && objId != 0)
 	{
@@ -238,15 +239,14 @@ void PlaySoundLocGlobal(const char* s,fixed gx,fixed gy,int chan,unsigned int ob
 	}
 
 	if (looped && objId != 0)
-	{
-		const SoundIndex &sound = SoundInfo.FindSound(s);
-		LoopedAudio::add (objId, channel, sound, attenuation, volume);
-	}
+		LoopedAudio::add (objId, channel, s, attenuation, volume);
 }
 
 void UpdateSoundLoc(void)
 {
-	for(int i = 0; i < MIX_CHANNELS; i++)
+	SD_UpdateVoices();
+
+	for(int i = 0; i < SD_MAXVOICES; i++)
 	{
 		if(channelSoundPos[i].valid)
 		{
@@ -468,6 +468,274 @@ void DBaseStatusBar::DrawActors ()
 }
 
 
+/*
+===================
+=
+= FRetainedArea
+=
+===================
+*/
+
+bool DBaseStatusBar::FRetainedArea::Graphic::operator==(const Graphic &other) const
+{
+	return tex == other.tex && remap == other.remap && fillcolor == other.fillcolor &&
+		x == other.x && y == other.y && w == other.w && h == other.h &&
+		cliptop == other.cliptop && clipbottom == other.clipbottom;
+}
+
+void DBaseStatusBar::FRetainedArea::Graphic::Draw(int cl, int ct, int cr, int cb) const
+{
+	if(!tex)
+		return;
+
+	if(fillcolor != 0xFFFFFFFF)
+	{
+		screen->DrawTexture(tex, x, y,
+			DTA_DestWidthF, w,
+			DTA_DestHeightF, h,
+			DTA_Translation, remap,
+			DTA_FillColor, fillcolor,
+			DTA_ClipLeft, cl,
+			DTA_ClipTop, MAX(ct, cliptop),
+			DTA_ClipRight, cr,
+			DTA_ClipBottom, MIN(cb, clipbottom),
+			TAG_DONE);
+	}
+	else
+	{
+		screen->DrawTexture(tex, x, y,
+			DTA_DestWidthF, w,
+			DTA_DestHeightF, h,
+			DTA_Translation, remap,
+			DTA_ClipLeft, cl,
+			DTA_ClipTop, MAX(ct, cliptop),
+			DTA_ClipRight, cr,
+			DTA_ClipBottom, MIN(cb, clipbottom),
+			TAG_DONE);
+	}
+}
+
+void DBaseStatusBar::FRetainedArea::Begin(FTexture *bgtex, double x, double y, double w, double h)
+{
+	if(bgtex != background.tex)
+		valid = false;
+
+	background.tex = bgtex;
+	background.x = x;
+	background.y = y;
+	background.w = w;
+	background.h = h;
+	background.remap = NULL;
+	background.fillcolor = 0xFFFFFFFF;
+	background.cliptop = 0;
+	background.clipbottom = 0x7FFFFFFF;
+
+	cur ^= 1;
+	graphics[cur].Clear();
+	widgets[cur].Clear();
+}
+
+void DBaseStatusBar::FRetainedArea::Begin(FTexture *bgtex, int ix, int iy)
+{
+	double x = ix, y = iy, w = 0, h = 0;
+	if(bgtex)
+	{
+		w = bgtex->GetScaledWidthDouble();
+		h = bgtex->GetScaledHeightDouble();
+	}
+	screen->VirtualToRealCoords(x, y, w, h, 320, 200, true, true);
+	Begin(bgtex, x, y, w, h);
+}
+
+void DBaseStatusBar::FRetainedArea::BeginWidget()
+{
+	Widget widget = { graphics[cur].Size(), 0, 0, 0, 0, 0 };
+	widgets[cur].Push(widget);
+}
+
+void DBaseStatusBar::FRetainedArea::AddGraphic(FTexture *tex, double x, double y, double w, double h,
+	FRemapTable *remap, uint32_t fillcolor, int cliptop, int clipbottom)
+{
+	if(!tex || widgets[cur].Size() == 0)
+		return;
+
+	Graphic graphic = { tex, x, y, w, h, remap, fillcolor, cliptop, clipbottom };
+	graphics[cur].Push(graphic);
+	++widgets[cur].Last().count;
+}
+
+void DBaseStatusBar::FRetainedArea::AddGraphic(FTexture *tex, int ix, int iy, FRemapTable *remap)
+{
+	if(!tex)
+		return;
+
+	double x = ix, y = iy;
+	double w = tex->GetScaledWidthDouble(), h = tex->GetScaledHeightDouble();
+	screen->VirtualToRealCoords(x, y, w, h, 320, 200, true, true);
+	AddGraphic(tex, x, y, w, h, remap);
+}
+
+void DBaseStatusBar::FRetainedArea::CalcBounds(Widget &widget) const
+{
+	widget.x1 = widget.y1 = INT_MAX;
+	widget.x2 = widget.y2 = INT_MIN;
+	for(unsigned int i = widget.first;i < widget.first+widget.count;++i)
+	{
+		const Graphic &g = graphics[cur][i];
+
+		// Same placement as DCanvas::DrawTexture
+		const double x0 = g.x - g.tex->GetScaledLeftOffsetDouble() * g.w / g.tex->GetScaledWidthDouble();
+		const double y0 = g.y - g.tex->GetScaledTopOffsetDouble() * g.h / g.tex->GetScaledHeightDouble();
+		widget.x1 = MIN(widget.x1, xs_FloorToInt(x0));
+		widget.y1 = MIN(widget.y1, MAX(xs_FloorToInt(y0), g.cliptop));
+		widget.x2 = MAX(widget.x2, xs_CeilToInt(x0 + g.w));
+		widget.y2 = MAX(widget.y2, MIN(xs_CeilToInt(y0 + g.h), g.clipbottom));
+	}
+}
+
+bool DBaseStatusBar::FRetainedArea::WidgetChanged(unsigned int i) const
+{
+	const Widget &widget = widgets[cur][i];
+	const Widget &last = widgets[cur^1][i];
+	if(widget.count != last.count)
+		return true;
+
+	for(unsigned int j = 0;j < widget.count;++j)
+	{
+		if(graphics[cur][widget.first+j] != graphics[cur^1][last.first+j])
+			return true;
+	}
+	return false;
+}
+
+static inline bool RectsOverlap(int ax1, int ay1, int ax2, int ay2, int bx1, int by1, int bx2, int by2)
+{
+	return ax1 < bx2 && bx1 < ax2 && ay1 < by2 && by1 < ay2;
+}
+
+void DBaseStatusBar::FRetainedArea::Finish()
+{
+	TArray<Widget> &cwidgets = widgets[cur];
+	const TArray<Widget> &lwidgets = widgets[cur^1];
+
+	// The cached area is what the background covers
+	const int x1 = MAX(0, xs_FloorToInt(background.x));
+	const int y1 = MAX(0, xs_FloorToInt(background.y));
+	const int x2 = MIN(screen->GetWidth(), xs_CeilToInt(background.x+background.w));
+	const int y2 = MIN(screen->GetHeight(), xs_CeilToInt(background.y+background.h));
+
+	// Anything which would move the cached pixels throws away the cache
+	if(x1 != areaX || y1 != areaY || x2-x1 != areaW || y2-y1 != areaH ||
+		screenW != screen->GetWidth() || screenH != screen->GetHeight())
+	{
+		valid = false;
+		areaX = x1;
+		areaY = y1;
+		areaW = x2-x1;
+		areaH = y2-y1;
+		screenW = screen->GetWidth();
+		screenH = screen->GetHeight();
+	}
+
+	// Widgets placed outside of the background (possible with custom
+	// layouts) would leave whatever is under them in the cache, so just draw
+	// everything every frame in that case.
+	bool retain = background.tex && areaW > 0 && areaH > 0;
+	for(unsigned int i = 0;i < cwidgets.Size();++i)
+	{
+		Widget &widget = cwidgets[i];
+		CalcBounds(widget);
+		if(widget.count && (widget.x1 < areaX || widget.y1 < areaY ||
+			widget.x2 > areaX+areaW || widget.y2 > areaY+areaH))
+		{
+			retain = false;
+		}
+	}
+
+	screen->Lock(false);
+
+	if(!retain || !valid || cwidgets.Size() != lwidgets.Size())
+	{
+		background.Draw(0, 0, screenW, screenH);
+		for(unsigned int i = 0;i < graphics[cur].Size();++i)
+			graphics[cur][i].Draw(0, 0, screenW, screenH);
+
+		if((valid = retain))
+		{
+			image.Resize(areaW*areaH);
+			screen->GetBlock(areaX, areaY, areaW, areaH, &image[0]);
+		}
+		screen->Unlock();
+		return;
+	}
+
+	screen->DrawBlock(areaX, areaY, areaW, areaH, &image[0]);
+
+	// Find the widgets which changed and clear what they used to cover as
+	// well as where they're going to be drawn now.
+	bool dirty = false;
+	redraw.Resize(cwidgets.Size());
+	for(unsigned int i = 0;i < cwidgets.Size();++i)
+	{
+		Widget &widget = cwidgets[i];
+		redraw[i] = WidgetChanged(i);
+		if(!redraw[i])
+			continue;
+
+		dirty = true;
+		widget.x1 = MIN(widget.x1, lwidgets[i].x1);
+		widget.y1 = MIN(widget.y1, lwidgets[i].y1);
+		widget.x2 = MAX(widget.x2, lwidgets[i].x2);
+		widget.y2 = MAX(widget.y2, lwidgets[i].y2);
+		background.Draw(widget.x1, widget.y1, widget.x2, widget.y2);
+	}
+
+	if(!dirty)
+	{
+		screen->Unlock();
+		return;
+	}
+
+	// Anything touching a repainted widget needs to be drawn again too so
+	// the overlap order is preserved. Redrawing an unchanged widget over
+	// itself is harmless.
+	bool added;
+	do
+	{
+		added = false;
+		for(unsigned int i = 0;i < cwidgets.Size();++i)
+		{
+			if(redraw[i])
+				continue;
+
+			for(unsigned int j = 0;j < cwidgets.Size();++j)
+			{
+				if(redraw[j] && RectsOverlap(cwidgets[i].x1, cwidgets[i].y1, cwidgets[i].x2, cwidgets[i].y2,
+					cwidgets[j].x1, cwidgets[j].y1, cwidgets[j].x2, cwidgets[j].y2))
+				{
+					redraw[i] = added = true;
+					break;
+				}
+			}
+		}
+	}
+	while(added);
+
+	for(unsigned int i = 0;i < cwidgets.Size();++i)
+	{
+		if(!redraw[i])
+			continue;
+
+		const Widget &widget = cwidgets[i];
+		for(unsigned int j = widget.first;j < widget.first+widget.count;++j)
+			graphics[cur][j].Draw(0, 0, screenW, screenH);
+	}
+
+	screen->GetBlock(areaX, areaY, areaW, areaH, &image[0]);
+	screen->Unlock();
+}
+
+
 /*
 ===================
 =
@@ -1104,6 +1372,29 @@ restartgame:
 	return false;
 }
 
+/*
+===================
+=
+= SimulateGame
+=
+= Sets up the level started by NewGame and runs it without drawing.
+=
+===================
+*/
+
+void SimulateGame (unsigned int numtics)
+{
+	startgame = false;
+	SetupGameLevel ();
+	FinishTravel ();
+
+	ingame = true;
+	SimulateLoop (numtics);
+	ingame = false;
+
+	StopMusic ();
+}
+
 //==========================================================================
 
 namespace LoopedAudio
@@ -1216,7 +1507,7 @@ namespace LoopedAudio
 			AActor *ob = actors[it->first];
 			Chan &chan = it->second;
 
-			// group 2 has 2 channels only
+			// only the 2 closest looped sounds are kept playing
 			// so stop looped audio from objects too distant
 			if (closestCounter >= 2 || (MusicMode == smm_Off && chan.volume < 0))
 			{
@@ -1226,7 +1517,7 @@ namespace LoopedAudio
 					if (soundpos->valid)
 					{
 						soundpos->valid = 0;
-						Mix_HaltChannel(chan.channel);
+						SD_HaltChannel(chan.channel);
 					}
 
 					chan.channel = -1;
@@ -1242,8 +1533,7 @@ namespace LoopedAudio
 					const double volume = chan.volume;
 					chans.erase(it);
 
-					const char *s = SoundInfo[sound].GetLogicalChars();
-					PlaySoundLocGlobal(s, ob->x, ob->y, SD_GENERIC, ob->spawnid, true, attenuation, volume);
+					PlaySoundLocGlobal(sound, ob->x, ob->y, SD_GENERIC, ob->spawnid, true, attenuation, volume);
 					break;
 				}
 			}
@@ -1277,7 +1567,7 @@ namespace LoopedAudio
 				if (soundpos->valid)
 				{
 					soundpos->valid = 0;
-					Mix_HaltChannel(chan.channel);
+					SD_HaltChannel(chan.channel);
 				}
 
 				if(halt_only)
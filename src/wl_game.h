@@ -5,6 +5,7 @@
 #include <string>
 #include "textures/textures.h"
 #include "farchive.h"
+#include "sndinfo.h"
 
 /*
 =============================================================================
@@ -194,6 +195,7 @@ extern  char            demoname[13];
 
 void    SetupGameLevel (void);
 bool    GameLoop (void);
+void    SimulateGame (unsigned int numtics);
 void    DrawPlayScreen (bool noborder=false);
 void    DrawPlayBorderSides (void);
 
@@ -219,11 +221,9 @@ extern struct NewMap_t
 #define PlaySoundLocTile(s,tx,ty)       PlaySoundLocGlobal(s,(((int32_t)(tx) << TILESHIFT) + (1L << (TILESHIFT - 1))),(((int32_t)ty << TILESHIFT) + (1L << (TILESHIFT - 1))),SD_GENERIC)
 #define PlaySoundLocActor(s,ob)         PlaySoundLocGlobal(s,(ob)->x,(ob)->y,SD_GENERIC)
 #define PlaySoundLocActorBoss(s,ob)     PlaySoundLocGlobal(s,(ob)->x,(ob)->y,SD_BOSSWEAPONS)
-void    PlaySoundLocGlobal(const char* s,fixed gx,fixed gy,int chan,unsigned int objId=0,bool looped=false,double attenuation=0.0,double volume=1.0);
+void    PlaySoundLocGlobal(const SoundIndex &s,fixed gx,fixed gy,int chan,unsigned int objId=0,bool looped=false,double attenuation=0.0,double volume=1.0);
 void UpdateSoundLoc(void);
 
-class SoundIndex;
-
 namespace LoopedAudio
 {
 	typedef unsigned int ObjId;
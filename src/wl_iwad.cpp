@@ -32,10 +32,13 @@
 **
 */
 
+#include <sys/stat.h>
+
 #include "resourcefiles/resourcefile.h"
 #include "config.h"
 #include "filesys.h"
 #include "lumpremap.h"
+#include "m_crc32.h"
 #include "scanner.h"
 #include "tarray.h"
 #include "tmemory.h"
@@ -152,9 +155,8 @@ static int CheckData(WadStuff &wad)
 	return wad.Type;
 }
 
-static bool CheckStandalone(const char* directory, FString filename, FString extension, TArray<WadStuff> &iwads)
+static bool CheckStandalone(const char* directory, FString filename, FString extension, WadStuff &wad)
 {
-	WadStuff wad;
 	for(unsigned int i = 0;i < iwadNames.Size();++i)
 	{
 		if(filename.CompareNoCase(iwadNames[i]) != 0)
@@ -174,7 +176,6 @@ static bool CheckStandalone(const char* directory, FString filename, FString ext
 				wad.Extension = extension;
 				wad.Name = iwadTypes[wad.Type].Name;
 				wad.Hidden = CheckHidden(iwadTypes[wad.Type]);
-				iwads.Push(wad);
 				return true;
 			}
 		}
@@ -303,6 +304,245 @@ static bool VerifySpearInstall(const char* directory)
 	return false;
 }
 
+/* Identifying game data means opening every candidate file in every search
+ * path, so the results are remembered in the cache directory.  Each directory
+ * is keyed by a checksum of its modification time and the name, size and
+ * modification time of every file in it, salted with the engine version and
+ * the data pk3 (which holds IWADINFO and the remap tables).  If anything
+ * changes the directory is simply probed again.
+ */
+struct CachedWad
+{
+	FString TypeName;
+	FString Extension;
+	TArray<FString> Path;
+	bool Standalone;
+};
+struct CachedDirectory
+{
+	FString Directory;
+	DWORD Signature;
+	TArray<CachedWad> Wads;
+	bool Used;
+};
+static TArray<CachedDirectory> discoveryCache;
+static DWORD discoverySalt;
+static bool discoveryCacheDirty;
+
+static FString GetDiscoveryCachePath()
+{
+	return FileSys::GetDirectoryPath(FileSys::DIR_Cache) + PATH_SEPARATOR "iwadcache.txt";
+}
+
+static bool AddFileSignature(DWORD &crc, const char* path)
+{
+	struct stat info;
+	if(stat(path, &info) != 0)
+		return false;
+
+	const int64_t data[2] = { (int64_t)info.st_size, (int64_t)info.st_mtime };
+	crc = AddCRC32(crc, (const BYTE*)data, sizeof(data));
+	return true;
+}
+
+// Returns false if the directory can't be fingerprinted and shouldn't be cached.
+static bool GetDirectorySignature(const char* directory, const TArray<FString> &files, DWORD &signature)
+{
+	signature = discoverySalt;
+	if(!AddFileSignature(signature, directory))
+		return false;
+
+	for(unsigned int i = 0;i < files.Size();++i)
+	{
+		FString path;
+		path.Format("%s" PATH_SEPARATOR "%s", directory, files[i].GetChars());
+
+		signature = AddCRC32(signature, (const BYTE*)files[i].GetChars(), (unsigned int)files[i].Len()+1);
+		if(!AddFileSignature(signature, path))
+			return false;
+	}
+	return true;
+}
+
+static int FindTypeByName(const FString &name)
+{
+	for(unsigned int i = 0;i < iwadTypes.Size();++i)
+	{
+		if(iwadTypes[i].Name.Compare(name) == 0)
+			return i;
+	}
+	return -1;
+}
+
+static void SplitTabs(const FString &line, TArray<FString> &fields)
+{
+	long start = 0;
+	long tab;
+	while((tab = line.IndexOf('\t', start)) != -1)
+	{
+		fields.Push(line.Mid(start, tab-start));
+		start = tab+1;
+	}
+	fields.Push(line.Mid(start));
+}
+
+static void LoadDiscoveryCache(const char* datawad)
+{
+	FString version = GetVersionHash();
+	discoverySalt = CalcCRC32((const BYTE*)version.GetChars(), (unsigned int)version.Len());
+	AddFileSignature(discoverySalt, datawad);
+
+	FILE *file = File(GetDiscoveryCachePath()).open("rb");
+	if(!file)
+		return;
+
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	FString data;
+	if(size > 0)
+	{
+		TUniquePtr<char[]> buffer(new char[size]);
+		if(fread(buffer.Get(), 1, size, file) == (size_t)size)
+			data = FString(buffer.Get(), size);
+	}
+	fclose(file);
+
+	// The first line holds the salt the rest of the file was written with.
+	long lineEnd = data.IndexOf('\n');
+	if(lineEnd == -1 || strtoul(data.Left(lineEnd), NULL, 16) != discoverySalt)
+		return;
+
+	CachedDirectory *dir = NULL;
+	for(long start = lineEnd+1;start < (long)data.Len();start = lineEnd+1)
+	{
+		if((lineEnd = data.IndexOf('\n', start)) == -1)
+			lineEnd = data.Len();
+
+		TArray<FString> fields;
+		SplitTabs(data.Mid(start, lineEnd-start), fields);
+		if(fields[0].Compare("D") == 0 && fields.Size() == 3)
+		{
+			dir = &discoveryCache[discoveryCache.Push(CachedDirectory())];
+			dir->Signature = strtoul(fields[1], NULL, 16);
+			dir->Directory = fields[2];
+			dir->Used = false;
+		}
+		else if(fields[0].Compare("W") == 0 && fields.Size() > 4 && dir)
+		{
+			CachedWad &wad = dir->Wads[dir->Wads.Push(CachedWad())];
+			wad.Standalone = fields[1].Compare("S") == 0;
+			wad.TypeName = fields[2];
+			wad.Extension = fields[3];
+			for(unsigned int i = 4;i < fields.Size();++i)
+				wad.Path.Push(fields[i]);
+		}
+	}
+}
+
+static void SaveDiscoveryCache()
+{
+	// Drop directories which are no longer searched.
+	for(unsigned int i = discoveryCache.Size();i-- > 0;)
+	{
+		if(!discoveryCache[i].Used)
+		{
+			discoveryCache.Delete(i);
+			discoveryCacheDirty = true;
+		}
+	}
+
+	if(!discoveryCacheDirty)
+		return;
+
+	FILE *file = File(GetDiscoveryCachePath()).open("wb");
+	if(!file)
+		return;
+
+	fprintf(file, "%08X\n", discoverySalt);
+	for(unsigned int i = 0;i < discoveryCache.Size();++i)
+	{
+		const CachedDirectory &dir = discoveryCache[i];
+		fprintf(file, "D\t%08X\t%s\n", dir.Signature, dir.Directory.GetChars());
+		for(unsigned int j = 0;j < dir.Wads.Size();++j)
+		{
+			const CachedWad &wad = dir.Wads[j];
+			fprintf(file, "W\t%s\t%s\t%s", wad.Standalone ? "S" : "B", wad.TypeName.GetChars(), wad.Extension.GetChars());
+			for(unsigned int k = 0;k < wad.Path.Size();++k)
+				fprintf(file, "\t%s", wad.Path[k].GetChars());
+			fputc('\n', file);
+		}
+	}
+	fclose(file);
+}
+
+static const CachedDirectory *FindCachedDirectory(const char* directory, DWORD signature)
+{
+	for(unsigned int i = 0;i < discoveryCache.Size();++i)
+	{
+		CachedDirectory &dir = discoveryCache[i];
+		if(dir.Signature != signature || dir.Directory.Compare(directory) != 0)
+			continue;
+
+		// Something in the cache we don't know about means IWADINFO changed
+		// underneath us, so treat it as a miss.
+		for(unsigned int j = 0;j < dir.Wads.Size();++j)
+		{
+			if(FindTypeByName(dir.Wads[j].TypeName) < 0)
+				return NULL;
+		}
+
+		dir.Used = true;
+		return &dir;
+	}
+	return NULL;
+}
+
+static void RecordWad(CachedDirectory &dir, const WadStuff &wad, bool standalone)
+{
+	CachedWad &cached = dir.Wads[dir.Wads.Push(CachedWad())];
+	cached.TypeName = iwadTypes[wad.Type].Name;
+	cached.Extension = wad.Extension;
+	cached.Path = wad.Path;
+	cached.Standalone = standalone;
+}
+
+// Standalone data is always added, but base data only if we haven't already
+// found the same game elsewhere.
+static void AddDiscoveredGameData(TArray<WadStuff> &iwads, const CachedDirectory &dir)
+{
+	for(unsigned int i = 0;i < dir.Wads.Size();++i)
+	{
+		const CachedWad &cached = dir.Wads[i];
+
+		WadStuff wad;
+		wad.Type = FindTypeByName(cached.TypeName);
+		if(wad.Type < 0)
+			continue;
+
+		if(!cached.Standalone)
+		{
+			bool duplicate = false;
+			for(unsigned int j = 0;j < iwads.Size();++j)
+			{
+				if(iwads[j].Type == wad.Type)
+				{
+					duplicate = true;
+					break;
+				}
+			}
+			if(duplicate)
+				continue;
+		}
+
+		wad.Path = cached.Path;
+		wad.Extension = cached.Extension;
+		wad.Name = iwadTypes[wad.Type].Name;
+		wad.Hidden = CheckHidden(iwadTypes[wad.Type]);
+		iwads.Push(wad);
+	}
+}
+
 /* Find valid game data.  Due to the nature of WOlf3D we must collect
  * information by extensions.  An extension is considered valid if it has all
  * files needed.  If the OS is case sensitive then the case sensitivity only
@@ -327,14 +567,36 @@ static void LookForGameData(FResourceFile *res, TArray<WadStuff> &iwads, const c
 		dir = File(directory); // Repopulate the file list
 
 	TArray<FString> files = dir.getFileList();
+
+	DWORD signature;
+	const bool cacheable = GetDirectorySignature(directory, files, signature);
+	if(cacheable)
+	{
+		const CachedDirectory *cached = FindCachedDirectory(directory, signature);
+		if(cached)
+		{
+			AddDiscoveredGameData(iwads, *cached);
+			return;
+		}
+	}
+
+	CachedDirectory probed;
+	probed.Directory = directory;
+	probed.Signature = signature;
+	probed.Used = true;
+
 	for(unsigned int i = 0;i < files.Size();++i)
 	{
 		FString name, extension;
 		if(!SplitFilename(files[i], name, extension))
 			continue;
 
-		if(CheckStandalone(directory, files[i], extension, iwads))
+		WadStuff standalone;
+		if(CheckStandalone(directory, files[i], extension, standalone))
+		{
+			RecordWad(probed, standalone, true);
 			continue;
+		}
 
 		BaseFile *base = NULL;
 		for(unsigned int j = 0;j < foundFiles.Size();++j)
@@ -400,28 +662,23 @@ static void LookForGameData(FResourceFile *res, TArray<WadStuff> &iwads, const c
 
 		if(CheckData(wadStuff) > -1)
 		{
-			// Check to ensure there are no duplicates
-			bool doPush = true;
-			for(unsigned int j = 0;j < iwads.Size();++j)
+			// Duplicates are filtered out by AddDiscoveredGameData
+			if(iwadTypes[wadStuff.Type].Required.Size() > 0 ||
+				(foundFiles[i].isValid & FILE_REQMASK) == FILE_REQMASK)
 			{
-				if(iwads[j].Type == wadStuff.Type)
-				{
-					doPush = false;
-					break;
-				}
-			}
-			if(doPush)
-			{
-				if(iwadTypes[wadStuff.Type].Required.Size() > 0 ||
-					(foundFiles[i].isValid & FILE_REQMASK) == FILE_REQMASK)
-				{
-					iwads.Push(wadStuff);
-				}
+				RecordWad(probed, wadStuff, false);
 			}
 		}
 	}
 
 	LumpRemapper::ClearRemaps();
+
+	AddDiscoveredGameData(iwads, probed);
+	if(cacheable)
+	{
+		discoveryCache.Push(probed);
+		discoveryCacheDirty = true;
+	}
 }
 
 /**
@@ -603,6 +860,7 @@ void SelectGame(TArray<FString> &wadfiles, const char* iwad, const char* datawad
 		I_Error("Could not open %s!", datawad);
 
 	ParseIWadInfo(datawadRes);
+	LoadDiscoveryCache(datawadRes->Filename);
 
 	// Get a list of potential data paths
 	FString dataPaths;
@@ -713,6 +971,7 @@ void SelectGame(TArray<FString> &wadfiles, const char* iwad, const char* datawad
 		}
 	}
 
+	SaveDiscoveryCache();
 	delete datawadRes;
 
 	// Check requirements now as opposed to with LookForGameData so that reqs
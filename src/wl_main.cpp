@@ -47,9 +47,12 @@
 #include "g_conversation.h"
 #include "g_intermission.h"
 #include "m_argv.h"
+#include "m_capture.h"
 #include "c_console.h"
+#include "c_dispatch.h"
 #include "c_bind.h"
 
+#include <chrono>
 #include <clocale>
 
 /*
@@ -123,6 +126,10 @@ int     panyadjustment;
 bool param_nowait = false;
 int     param_difficulty = 1;           // default is "normal"
 const char* param_tedlevel = NULL;            // default is not to start a level
+unsigned int param_simulate = 0;              // tics to run headless with --nodraw
+unsigned int param_capturefps = 0;            // record frames from startup with --capture
+bool param_capturepng = false;
+bool param_startuptimes = false;
 int     param_joystickindex = 0;
 
 int     param_joystickhat = -1;
@@ -377,6 +384,45 @@ static bool DrawStartupConsole()
 	return true;
 }
 
+/*
+=====================
+=
+= EndStartupPhase
+=
+= Startup is timed phase by phase so --startuptimes can show where a launch
+= spends its time. Each call closes the phase that began with the last one.
+=
+=====================
+*/
+
+struct StartupPhase
+{
+	const char *name;
+	unsigned int ms;
+};
+static TArray<StartupPhase> startupPhases;
+static std::chrono::steady_clock::time_point startupPhaseStart = std::chrono::steady_clock::now();
+
+static void EndStartupPhase(const char *name)
+{
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	StartupPhase phase = { name, (unsigned int)std::chrono::duration_cast<std::chrono::milliseconds>(now - startupPhaseStart).count() };
+	startupPhases.Push(phase);
+	startupPhaseStart = now;
+}
+
+static void PrintStartupTimes()
+{
+	unsigned int total = 0;
+	Printf("Startup times:\n");
+	for(unsigned int i = 0;i < startupPhases.Size();++i)
+	{
+		Printf("  %-24s %6u ms\n", startupPhases[i].name, startupPhases[i].ms);
+		total += startupPhases[i].ms;
+	}
+	Printf("  %-24s %6u ms\n", "Total", total);
+}
+
 void I_ShutdownGraphics();
 static void InitGame()
 {
@@ -391,6 +437,19 @@ static void InitGame()
 	printf("SDL_Init: Using SDL 1.2\n");
 #endif
 
+	// Nothing is shown when simulating, so don't require a display or sound
+	// device to be present.
+	if(param_simulate)
+	{
+#if SDL_VERSION_ATLEAST(2,0,0)
+		SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+		SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+#else
+		putenv((char*)"SDL_VIDEODRIVER=dummy");
+		putenv((char*)"SDL_AUDIODRIVER=dummy");
+#endif
+	}
+
 #if SDL_VERSION_ATLEAST(2,0,0)
 	if(SDL_Init(0) < 0)
 #else
@@ -403,6 +462,7 @@ static void InitGame()
 	atterm(SDL_Quit);
 
 	SDL_ShowCursor(SDL_DISABLE);
+	EndStartupPhase("SDL_Init");
 
 	//
 	// Mapinfo
@@ -415,22 +475,26 @@ static void InitGame()
 	// Gameinfo provides game language for the language system
 	//
 	language.SetGameLanguage(gameinfo.GameLanguage);
+	EndStartupPhase("G_ParseMapInfo (game)");
 
 	//
 	// Init texture manager
 	//
 
 	TexMan.Init();
+	EndStartupPhase("TexMan.Init");
 	printf("VL_ReadPalette: Setting up the Palette...\n");
 	VL_ReadPalette(gameinfo.GamePalette);
 	atterm(R_DeinitColormaps);
 	GenerateLookupTables();
+	EndStartupPhase("VL_ReadPalette");
 
 	//
 	// Fonts
 	//
 	V_InitFonts();
 	atterm(V_ClearFonts);
+	EndStartupPhase("V_InitFonts");
 
 //
 // load in and lock down some basic chunks
@@ -446,6 +510,7 @@ static void InitGame()
 
 	C_InitConsole(SCREENWIDTH, SCREENHEIGHT, true);
 	C_InitConback();
+	EndStartupPhase("VL_SetVGAPlaneMode");
 
 //
 // Load Actors
@@ -453,19 +518,25 @@ static void InitGame()
 
 	ClassDef::LoadActors();
 	atterm(CollectGC);
+	EndStartupPhase("ClassDef::LoadActors");
 
 	// I_ShutdownGraphics needs to be run before the class definitions are unloaded.
 	atterm (I_ShutdownGraphics);
 
 	// Parse non-gameinfo sections in MAPINFO
 	G_ParseMapInfo(false);
+	EndStartupPhase("G_ParseMapInfo (levels)");
 
 //
 // Fonts
 //
 	VH_Startup ();
 	IN_Startup ();
+	EndStartupPhase("IN_Startup");
+	// Digitized sounds keep converting in the background until
+	// SoundInfo.FinishLoading below.
 	SD_Startup ();
+	EndStartupPhase("SD_Startup");
 	printf("US_Startup: Starting the User Manager.\n");
 	US_Startup ();
 
@@ -485,6 +556,7 @@ static void InitGame()
 // Load the status bar
 //
 	CreateStatusBar();
+	EndStartupPhase("US_Startup, keys, status bar");
 
 //
 // initialize the menusalcProjection
@@ -500,6 +572,13 @@ static void InitGame()
 // Net game?
 //
 	Net::Init();
+	EndStartupPhase("CreateMenus, Net::Init");
+
+	SoundInfo.FinishLoading();
+	EndStartupPhase("Sound decoding wait");
+
+	if(param_startuptimes)
+		PrintStartupTimes();
 
 //
 // Finish signon screen
@@ -813,6 +892,12 @@ static void DemoLoop()
 	{
 		param_nowait = true;
 		NewGame(param_difficulty,param_tedlevel,false);
+
+		if (param_simulate)
+		{
+			SimulateGame(param_simulate);
+			Quit(NULL);
+		}
 	}
 
 
@@ -1041,6 +1126,15 @@ static const char* CheckParameters(int argc, char *argv[], TArray<FString> &file
 		}
 		else IFARG("--noadaptive")
 			noadaptive = true;
+		else IFARG("--nodraw")
+		{
+			if(++i >= argc || atoi(argv[i]) <= 0)
+			{
+				printf("The nodraw option is missing the number of tics argument!\n");
+				hasError = true;
+			}
+			else param_simulate = atoi(argv[i]);
+		}
 		else IFARG("--nodblbuf")
 			usedoublebuffering = false;
 		else IFARG("--extravbls")
@@ -1153,9 +1247,41 @@ static const char* CheckParameters(int argc, char *argv[], TArray<FString> &file
 		{
 			GameSave::param_foreginsave = true;
 		}
+		else IFARG("--capture")
+		{
+			if(++i >= argc)
+			{
+				printf("The capture option is missing the fps argument!\n");
+				hasError = true;
+			}
+			else param_capturefps = atoi(argv[i]);
+		}
+		else IFARG("--capturepng")
+			param_capturepng = true;
+		else IFARG("--startuptimes")
+			param_startuptimes = true;
+		else IFARG("--logfile")
+		{
+			if(++i >= argc)
+			{
+				printf("The logfile option is missing the file argument!\n");
+				hasError = true;
+			}
+			else execLogfile(argv[i]);
+		}
 		else
 			files.Push(argv[i]);
 	}
+	if(param_capturepng && !param_capturefps)
+	{
+		printf("The capturepng option requires a rate to be given with capture!\n");
+		hasError = true;
+	}
+	if(param_simulate && !param_tedlevel)
+	{
+		printf("The nodraw option requires a level to be given with tedlevel!\n");
+		hasError = true;
+	}
 	if(hasError || showHelp)
 	{
 		if(hasError) printf("\n");
@@ -1187,6 +1313,8 @@ static const char* CheckParameters(int argc, char *argv[], TArray<FString> &file
 			" --res <width> <height> Sets the screen resolution\n"
 			" --aspect <aspect>      Sets the aspect ratio.\n"
 			" --noadaptive           Disables adaptive tics.\n"
+			" --nodraw <tics>        Runs tedlevel for the given number of tics without\n"
+			"                        drawing or input and prints performance statistics\n"
 			" --bits <b>             Sets the screen color depth\n"
 			"                        (use this when you have palette/fading problems\n"
 			"                        allowed: 8, 16, 24, 32, default: \"best\" depth)\n"
@@ -1204,6 +1332,11 @@ static const char* CheckParameters(int argc, char *argv[], TArray<FString> &file
 			" --port <number>        Port number to use for network communications.\n"
 			" --debugnet             Enable network debugging messages.\n"
 			" --foreignsave          Disable save game validity checking.\n"
+			" --capture <fps>        Records the screen at the given rate to a raw RGB24\n"
+			"                        file in the screenshots directory\n"
+			" --capturepng           Records a PNG sequence instead of a raw file\n"
+			" --startuptimes         Prints how long each part of startup took\n"
+			" --logfile <file>       Writes console output to the given file\n"
 			, GetGameCaption(), defaultSampleRate
 		);
 		exit(1);
@@ -1322,6 +1455,7 @@ int WL_Main (int argc, char *argv[])
 
 		C_InitConsole(80*8, 25*80, false);
 		atterm(C_DeinitConsole);
+		EndStartupPhase("ReadConfig");
 
 		{
 			TArray<FString> wadfiles, files;
@@ -1329,6 +1463,7 @@ int WL_Main (int argc, char *argv[])
 			Printf("IWad: Selecting base game data.\n");
 			const char* extension = CheckParameters(argc, argv, wadfiles);
 			IWad::SelectGame(files, extension, MAIN_PK3, progdir);
+			EndStartupPhase("IWad::SelectGame");
 
 			for(unsigned int i = 0;i < wadfiles.Size();++i)
 				files.Push(wadfiles[i]);
@@ -1337,6 +1472,7 @@ int WL_Main (int argc, char *argv[])
 			Wads.InitMultipleFiles(files);
 			LumpRemapper::RemapAll();
 			language.SetupStrings();
+			EndStartupPhase("W_Init");
 		}
 
 		C_SetDefaultBindings();
@@ -1344,11 +1480,15 @@ int WL_Main (int argc, char *argv[])
 		InitThinkerList();
 
 		R_InitRenderer();
+		EndStartupPhase("R_InitRenderer");
 
 		printf("InitGame: Setting up the game...\n");
 		rngseed = I_MakeRNGSeed(); // May change after initializing a net game
 		InitGame();
 
+		if(param_capturefps)
+			M_StartRecording(param_capturefps, param_capturepng);
+
 		FRandom::StaticClearRandom();
 
 		printf("DemoLoop: Starting the game loop...\n");
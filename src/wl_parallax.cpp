@@ -9,6 +9,7 @@
 #include "g_mapinfo.h"
 
 extern fixed viewz;
+extern angle_t viewangle;
 
 #ifdef USE_FEATUREFLAGS
 
@@ -39,7 +40,7 @@ static int GetParallaxStartTexture()
 void DrawParallax(byte *vbuf, unsigned vbufPitch)
 {
 	int startpage = GetParallaxStartTexture();
-	int midangle = (players[ConsolePlayer].camera->angle)>>ANGLETOFINESHIFT;
+	int midangle = viewangle>>ANGLETOFINESHIFT;
 	int skyheight = viewheight >> 1;
 	int curtex = -1;
 	const byte *skytex = NULL;
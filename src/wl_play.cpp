@@ -1,5 +1,9 @@
 // WL_PLAY.C
 
+#include <chrono>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
 #include "c_cvars.h"
 #include "wl_def.h"
 #include "wl_menu.h"
@@ -68,6 +72,7 @@ unsigned int extravbls = 0; // to remove flicker (gray stuff at the bottom)
 //
 bool noadaptive = false;
 unsigned tics;
+static fixed ticfrac = FRACUNIT; // How far into the next tic we are rendering
 
 //
 // control info
@@ -206,6 +211,16 @@ void CalcTics()
 // calculate tics since last refresh for adaptive timing
 //
 
+	// Give the collector whatever is left before the next tic, within the
+	// frame budget. It gets at least a quarter of the budget even when
+	// there is no time to spare, so a game that never waits still collects
+	// here instead of in the middle of the tics.
+	if(GC::FrameBudget)
+	{
+		const int32_t idle = (int32_t)(((lasttimecount + 1) * 100) / 7 - SDL_GetTicks()) * 1000;
+		GC::IdleStep(clamp<int32_t>(idle, GC::FrameBudget/4, GC::FrameBudget));
+	}
+
 	// Have we arrived too soon?
 	while(lasttimecount == GetTimeCount()+1)
 		SDL_Delay(1);
@@ -218,15 +233,25 @@ void CalcTics()
 	tics = (curtime * 7) / 100 - lasttimecount;
 	if(!tics)
 	{
-		// wait until end of current tic
-		SDL_Delay(((lasttimecount + 1) * 100) / 7 - curtime);
-		tics = 1;
+		// With an uncapped frame rate we just draw another frame and let
+		// the renderer interpolate between the last two tics.
+		if(!vid_uncapped)
+		{
+			// wait until end of current tic
+			SDL_Delay(((lasttimecount + 1) * 100) / 7 - curtime);
+			tics = 1;
+		}
 	}
 	else if(noadaptive)
 		tics = 1;
 
 	lasttimecount += tics;
 
+	if(vid_uncapped)
+		ticfrac = clamp<int32_t>(curtime * 7 - lasttimecount * 100, 0, 100) * FRACUNIT / 100;
+	else
+		ticfrac = FRACUNIT;
+
 	if (tics>MAXTICS)
 		tics = MAXTICS;
 }
@@ -637,6 +662,7 @@ void ProcessEvents()
 			lasttimecount = (curtime * 7) / 100;    // yes, set to current timecount
 
 		tics = DEMOTICS;
+		ticfrac = FRACUNIT;
 	}
 	else
 		CalcTics ();
@@ -1073,6 +1099,113 @@ void FinishPaletteShifts (void)
 */
 int32_t funnyticount;
 
+/*
+===================
+=
+= Frame interpolation
+=
+= When the frame rate is uncapped we render between two tics by moving
+= actors part way from where they were at the start of the last tic to
+= where they are now. The real positions are restored before anything
+= else gets a chance to look at them.
+=
+===================
+*/
+
+struct InterpolatedActor
+{
+	AActor *actor;
+	fixed x, y;
+	angle_t angle;
+};
+static TArray<InterpolatedActor> interpolated;
+
+static void StoreInterpolation()
+{
+	for(AActor::Iterator iter = AActor::GetIterator();iter.Next();)
+	{
+		AActor *actor = iter;
+		actor->prevx = actor->x;
+		actor->prevy = actor->y;
+		actor->prevangle = actor->angle;
+		actor->prevtic = gamestate.TimeCount+1;
+	}
+}
+
+static void InterpolateActors()
+{
+	interpolated.Clear();
+	if(ticfrac >= FRACUNIT || Paused)
+		return;
+
+	for(AActor::Iterator iter = AActor::GetIterator();iter.Next();)
+	{
+		AActor *actor = iter;
+		if(actor->prevtic != gamestate.TimeCount)
+			continue;
+
+		const fixed dx = actor->x - actor->prevx;
+		const fixed dy = actor->y - actor->prevy;
+		const int32_t da = static_cast<int32_t>(actor->angle - actor->prevangle);
+		if(dx == 0 && dy == 0 && da == 0)
+			continue;
+
+		// Don't smear teleports across the screen
+		if(abs(dx) > TILEGLOBAL || abs(dy) > TILEGLOBAL)
+			continue;
+
+		InterpolatedActor &entry = interpolated[interpolated.Push(InterpolatedActor())];
+		entry.actor = actor;
+		entry.x = actor->x;
+		entry.y = actor->y;
+		entry.angle = actor->angle;
+
+		actor->x = actor->prevx + FixedMul(dx, ticfrac);
+		actor->y = actor->prevy + FixedMul(dy, ticfrac);
+		actor->angle = actor->prevangle + static_cast<angle_t>(static_cast<int32_t>((static_cast<int64_t>(da) * ticfrac) >> FRACBITS));
+	}
+}
+
+static void RestoreInterpolation()
+{
+	for(unsigned int i = 0;i < interpolated.Size();++i)
+	{
+		InterpolatedActor &entry = interpolated[i];
+		entry.actor->x = entry.x;
+		entry.actor->y = entry.y;
+		entry.actor->angle = entry.angle;
+	}
+	interpolated.Clear();
+}
+
+static void RunTics()
+{
+	if(Paused & 2)
+	{
+		static bool absolutes = false;
+
+		// If paused due to the automap, continue polling controls but don't tick anything.
+		PollControls(absolutes);
+
+		absolutes = !absolutes;
+	}
+	else
+	{
+		for (unsigned int i = 0;i < tics;++i)
+		{
+			PollControls(!i);
+
+			if(vid_uncapped)
+				StoreInterpolation();
+
+			++frameon;
+			++gamestate.TimeCount;
+			thinkerList->Tick();
+			AActor::FinishSpawningActors();
+		}
+	}
+}
+
 
 void PlayLoop (void)
 {
@@ -1119,41 +1252,38 @@ void PlayLoop (void)
 //
 // actor thinking
 //
-		madenoise = std::max(madenoise-1,0);
-
-		// Run tics
-		if(Paused & 2)
-		{
-			static bool absolutes = false;
-
-			// If paused due to the automap, continue polling controls but don't tick anything.
-			PollControls(absolutes);
+		if(tics)
+			madenoise = std::max(madenoise-1,0);
 
-			absolutes = !absolutes;
-		}
-		else
-		{
-			for (unsigned int i = 0;i < tics;++i)
-			{
-				PollControls(!i);
-
-				++frameon;
-				++gamestate.TimeCount;
-				thinkerList->Tick();
-				AActor::FinishSpawningActors();
-			}
-		}
+		if(!vid_pipelined)
+			RunTics();
 
 		C_Ticker();
 
 		UpdatePaletteShifts ();
 		DrawPlayScreen();
 
-		ThreeDRefresh ();
+		// When pipelined the frame is drawn before this frame's tics run, so
+		// it only lands between two tics if there are none to run.
+		if(vid_uncapped && !(vid_pipelined && tics))
+			InterpolateActors();
+
+		if(vid_pipelined)
+		{
+			// Draw the last tic on the render thread while the next ones run
+			ThreeDRefreshBegin ();
+			RestoreInterpolation();
+			RunTics();
+			R_SyncRefresh ();
+		}
+		else
+			ThreeDRefresh ();
 
 		if(automap && !gamestate.victoryflag)
 			BasicOverhead();
 
+		RestoreInterpolation();
+
 		//
 		// MAKE FUNNY FACE IF BJ DOESN'T MOVE FOR AWHILE
 		//
@@ -1173,7 +1303,8 @@ void PlayLoop (void)
 		CheckKeys ();
 		if (!loadedgame)
 		{
-			StatusBar->Tick();
+			if(tics)
+				StatusBar->Tick();
 			if ((gamestate.TimeCount & 1) || !(tics & 1))
 				StatusBar->DrawStatusBar();
 		}
@@ -1206,3 +1337,87 @@ void PlayLoop (void)
 	if (playstate != ex_died)
 		FinishPaletteShifts ();
 }
+
+/*
+===================
+=
+= SimulateLoop
+=
+= Runs the game logic for numtics tics as fast as possible without drawing
+= or reading input, then reports how it went. Used by --nodraw.
+=
+===================
+*/
+
+static size_t PeakMemoryUsage()
+{
+#ifndef _WIN32
+	struct rusage usage;
+	if(getrusage(RUSAGE_SELF, &usage) == 0)
+	{
+#ifdef __APPLE__
+		return usage.ru_maxrss;
+#else
+		return usage.ru_maxrss*1024;
+#endif
+	}
+#endif
+	return 0;
+}
+
+void SimulateLoop (unsigned int numtics)
+{
+	playstate = ex_stillplaying;
+	frameon = 0;
+	moveobj_frameon = 0;
+	projectile_frameon = 0;
+	memset (control[ConsolePlayer].buttonstate, 0, sizeof (control[ConsolePlayer].buttonstate));
+	tics = 1;
+
+	unsigned int numactors = 0, peakactors = 0;
+	const unsigned int startcycles = GC::Cycles;
+	GC::PeakAllocBytes = GC::AllocBytes;
+
+	// Only the tics themselves are timed, not the bookkeeping for the report.
+	std::chrono::steady_clock::duration simtime(0);
+	unsigned int ran;
+	for(ran = 0;ran < numtics && !playstate;++ran)
+	{
+		const std::chrono::steady_clock::time_point ticstart = std::chrono::steady_clock::now();
+
+		// Keep the event queue from filling up, but otherwise the player
+		// just stands there.
+		IN_ProcessEvents();
+
+		madenoise = std::max(madenoise-1,0);
+
+		++frameon;
+		++gamestate.TimeCount;
+		thinkerList->Tick();
+		AActor::FinishSpawningActors();
+
+		GC::CheckGC();
+		if(GC::FrameBudget)
+			GC::IdleStep(GC::FrameBudget);
+
+		simtime += std::chrono::steady_clock::now() - ticstart;
+
+		numactors = 0;
+		for(AActor::Iterator iter = AActor::GetIterator();iter.Next();)
+			++numactors;
+		peakactors = MAX(peakactors, numactors);
+	}
+	const uint32_t elapsed = MAX<uint32_t>((uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(simtime).count(), 1);
+
+	Printf("Simulated %u tics in %u ms (%.1f tics/sec, %.2fx real time)\n",
+		ran, elapsed, ran*1000.0/elapsed, ran*1000.0/elapsed/TICRATE);
+	if(playstate)
+		Printf("Stopped early, playstate %d\n", playstate);
+	Printf("Actors: %u at end, %u peak\n", numactors, peakactors);
+	Printf("GC: %u cycles, %u KiB allocated, %u KiB peak, threshold %u KiB\n",
+		GC::Cycles - startcycles, unsigned(GC::AllocBytes/1024),
+		unsigned(MAX(GC::PeakAllocBytes, GC::AllocBytes)/1024), unsigned(GC::Threshold/1024));
+	Printf("GC pauses: %s\n", GC::PauseReport().GetChars());
+	if(const size_t peakmem = PeakMemoryUsage())
+		Printf("Peak memory: %u KiB\n", unsigned(peakmem/1024));
+}
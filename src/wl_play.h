@@ -41,6 +41,7 @@ extern  int8_t      *demoptr, *lastdemoptr;
 extern  memptr      demobuffer;
 
 void    PlayLoop (void);
+void    SimulateLoop (unsigned int numtics);
 
 void    InitRedShifts (void);
 void    FinishPaletteShifts (void);
@@ -1032,15 +1032,14 @@ bool CheckLine (AActor *ob, AActor *ob2)
 			y = yfrac>>8;
 			yfrac += ystep;
 
-			MapSpot spot = map->GetSpot(x, y, 0);
-			
-			if (!spot->tile)
+			if (!(map->GetSpotFlags(x, y, 0) & SPOT_Tile))
 			{
 				if (CheckAdjacentTileBlockage(x, y, lastx, lasty))
 					return false;
 			}
 			else 
 			{
+				MapSpot spot = map->GetSpot(x, y, 0);
 				if (spot->slideAmount[direction] == 0)
 					return false;
 
@@ -1098,15 +1097,14 @@ bool CheckLine (AActor *ob, AActor *ob2)
 			x = xfrac>>8;
 			xfrac += xstep;
 
-			MapSpot spot = map->GetSpot(x, y, 0);
-
-			if (!spot->tile)
+			if (!(map->GetSpotFlags(x, y, 0) & SPOT_Tile))
 			{
 				if (CheckAdjacentTileBlockage(x, y, lastx, lasty))
 					return false;
 			}
 			else 
 			{
+				MapSpot spot = map->GetSpot(x, y, 0);
 				if (spot->slideAmount[direction] == 0)
 					return false;
 